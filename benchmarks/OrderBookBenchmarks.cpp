@@ -108,6 +108,38 @@ static void BM_Get_Best_Bid(benchmark::State &state) {
     state.SetItemsProcessed(i);
 }
 
+static void BM_Get_Top_Of_Book(benchmark::State &state) {
+    spdlog::set_level(spdlog::level::err);
+    const std::string USERNAME = "test";
+    uint64_t i = 0;
+    for (auto _: state) {
+        auto book = createOrderBook();
+        Order bid(OrderCore(USERNAME, 1), 500, 100, true);
+        book.AddOrder(bid);
+        auto start = std::chrono::high_resolution_clock::now();
+        benchmark::DoNotOptimize(book.GetTopOfBook());
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed_seconds =
+                std::chrono::duration_cast<std::chrono::duration<double>>(
+                        end - start);
+        state.SetIterationTime(elapsed_seconds.count());
+        i++;
+    }
+    state.SetItemsProcessed(i);
+}
+
+static void BM_Message_Timestamp(benchmark::State &state) {
+    for (auto _: state) {
+        benchmark::DoNotOptimize(mdfeed::message_utils::get_timestamp_ns());
+    }
+}
+
+static void BM_System_Clock(benchmark::State &state) {
+    for (auto _: state) {
+        benchmark::DoNotOptimize(std::chrono::system_clock::now());
+    }
+}
+
 static void BM_Add_Order_Existing_Limit(benchmark::State &state) {
     spdlog::set_level(spdlog::level::err);
     const int SECURITY_ID = 1;
@@ -281,6 +313,9 @@ BENCHMARK(BM_PlaceMarketOrder)->UseManualTime();
 BENCHMARK(BM_PlaceMarketOrderAcross3Bids)->UseManualTime();
 BENCHMARK(BM_Get_Order)->UseManualTime();
 BENCHMARK(BM_Get_Best_Bid)->UseManualTime();
+BENCHMARK(BM_Get_Top_Of_Book)->UseManualTime();
+BENCHMARK(BM_Message_Timestamp);
+BENCHMARK(BM_System_Clock);
 BENCHMARK(BM_Run_Simulation)->UseManualTime();
 BENCHMARK(BM_Add_Order_New_Limit)->UseManualTime();
 BENCHMARK(BM_Add_Order_Existing_Limit)->UseManualTime();
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define COMMON_HAS_TSC 1
+#endif
+
+namespace common
+{
+    // Wall-clock nanoseconds derived from the invariant TSC. A tick delta is
+    // converted with a multiply and shift against a system_clock anchor taken
+    // at startup and refreshed by recalibrate(). Without an invariant TSC, or
+    // if calibration produces an implausible rate, every call falls back to
+    // std::chrono::system_clock. Calibration busy-waits 5ms when instance() is
+    // first called, so owners of hot threads (MarketDataPublisher, the
+    // receivers) call it from their constructors to keep that off the stream.
+    class TscClock
+    {
+    public:
+        static TscClock& instance()
+        {
+            static TscClock clock;
+            return clock;
+        }
+
+        static uint64_t now_ns()
+        {
+            return instance().read_ns();
+        }
+
+        // raw counter for hot-path instrumentation, convert deltas with ticks_to_ns
+        [[nodiscard]] uint64_t ticks() const
+        {
+#ifdef COMMON_HAS_TSC
+            if (use_tsc_.load(std::memory_order_relaxed))
+            {
+                return __rdtsc();
+            }
+#endif
+            return system_ns();
+        }
+
+        [[nodiscard]] uint64_t ticks_to_ns(uint64_t ticks) const
+        {
+            if (!use_tsc_.load(std::memory_order_relaxed))
+            {
+                return ticks;
+            }
+            return scale(ticks, mult_.load(std::memory_order_relaxed));
+        }
+
+        [[nodiscard]] uint64_t read_ns() const
+        {
+#ifdef COMMON_HAS_TSC
+            if (use_tsc_.load(std::memory_order_relaxed))
+            {
+                uint32_t before;
+                uint64_t anchor_ticks, anchor_ns, mult;
+                do
+                {
+                    before = seq_.load(std::memory_order_acquire);
+                    anchor_ticks = anchor_ticks_.load(std::memory_order_relaxed);
+                    anchor_ns = anchor_ns_.load(std::memory_order_relaxed);
+                    mult = mult_.load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                }
+                while ((before & 1) || before != seq_.load(std::memory_order_relaxed));
+
+                const uint64_t now = __rdtsc();
+                // an anchor taken on another core can be a few ticks ahead
+                return now > anchor_ticks ? anchor_ns + scale(now - anchor_ticks, mult) : anchor_ns;
+            }
+#endif
+            return system_ns();
+        }
+
+        // Re-anchors to system_clock and refines the rate over the whole run so
+        // far. Any thread may call it; while one is re-anchoring, the others
+        // return false without touching the clock, so the seqlock keeps a
+        // single writer.
+        bool recalibrate()
+        {
+#ifdef COMMON_HAS_TSC
+            if (!use_tsc_.load(std::memory_order_relaxed)
+                || recalibrating_.exchange(true, std::memory_order_acquire))
+            {
+                return false;
+            }
+            const auto [ticks, ns] = sample();
+            uint64_t mult = mult_.load(std::memory_order_relaxed);
+            if (ns > start_ns_ && ticks > start_ticks_)
+            {
+                const uint64_t refined = rate_to_mult(ticks - start_ticks_, ns - start_ns_);
+                // a stepped wall clock skews the long baseline; keep the old rate then
+                const uint64_t drift = refined > mult ? refined - mult : mult - refined;
+                if (drift < mult / 100)
+                {
+                    mult = refined;
+                }
+            }
+            const uint32_t seq = seq_.load(std::memory_order_relaxed);
+            seq_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            anchor_ticks_.store(ticks, std::memory_order_relaxed);
+            anchor_ns_.store(ns, std::memory_order_relaxed);
+            mult_.store(mult, std::memory_order_relaxed);
+            seq_.store(seq + 2, std::memory_order_release);
+            recalibrating_.store(false, std::memory_order_release);
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        [[nodiscard]] bool using_tsc() const { return use_tsc_.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr unsigned SHIFT = 32;
+        static constexpr uint64_t LOW_MASK = (uint64_t{1} << SHIFT) - 1;
+
+        TscClock()
+        {
+#ifdef COMMON_HAS_TSC
+            if (!has_invariant_tsc())
+            {
+                return;
+            }
+            const auto [ticks0, ns0] = sample();
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+            while (std::chrono::steady_clock::now() < deadline)
+            {
+            }
+            const auto [ticks1, ns1] = sample();
+            if (ns1 <= ns0 || ticks1 <= ticks0)
+            {
+                return;
+            }
+            // the split multiply needs mult below 2^32, i.e. a TSC faster than 1GHz
+            const uint64_t mult = rate_to_mult(ticks1 - ticks0, ns1 - ns0);
+            if (mult == 0 || mult > LOW_MASK)
+            {
+                return;
+            }
+            start_ticks_ = ticks0;
+            start_ns_ = ns0;
+            anchor_ticks_.store(ticks1, std::memory_order_relaxed);
+            anchor_ns_.store(ns1, std::memory_order_relaxed);
+            mult_.store(mult, std::memory_order_relaxed);
+            use_tsc_.store(true, std::memory_order_release);
+#endif
+        }
+
+        static uint64_t system_ns()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()
+            ).count();
+        }
+
+        // ticks * mult >> SHIFT without a 128-bit product
+        static uint64_t scale(uint64_t ticks, uint64_t mult)
+        {
+            return (ticks >> SHIFT) * mult + (((ticks & LOW_MASK) * mult) >> SHIFT);
+        }
+
+        static uint64_t rate_to_mult(uint64_t ticks, uint64_t ns)
+        {
+            return static_cast<uint64_t>(static_cast<long double>(ns) * (uint64_t{1} << SHIFT) / ticks);
+        }
+
+#ifdef COMMON_HAS_TSC
+        static bool has_invariant_tsc()
+        {
+            unsigned eax, ebx, ecx, edx;
+            if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007)
+            {
+                return false;
+            }
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+            return (edx & (1u << 8)) != 0;
+        }
+
+        struct Sample
+        {
+            uint64_t ticks;
+            uint64_t ns;
+        };
+
+        // wall clock read bracketed by two TSC reads, paired with their midpoint
+        static Sample sample()
+        {
+            const uint64_t before = __rdtsc();
+            const uint64_t ns = system_ns();
+            const uint64_t after = __rdtsc();
+            return {before + (after - before) / 2, ns};
+        }
+#endif
+
+        std::atomic<bool> use_tsc_{false};
+#ifdef COMMON_HAS_TSC
+        uint64_t start_ticks_ = 0;
+        uint64_t start_ns_ = 0;
+#endif
+
+        std::atomic<bool> recalibrating_{false};
+        alignas(64) std::atomic<uint32_t> seq_{0};
+        std::atomic<uint64_t> anchor_ticks_{0};
+        std::atomic<uint64_t> anchor_ns_{0};
+        std::atomic<uint64_t> mult_{0};
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/TscClock.h"
 #include <chrono>
 #include <string>
 #include <sstream>
@@ -9,6 +10,25 @@ namespace mdfeed
 {
 #pragma pack(push, 1)
 
+    enum class PacketFormat : uint8_t
+    {
+        // message_count complete messages, each carrying its own MessageHeader
+        PLAIN = 0,
+        // a CompactPacketBase followed by delta/varint encoded messages, see CompactCodec.h
+        COMPACT = 1
+    };
+
+    // Every datagram starts with a packet header followed by message_count messages
+    struct PacketHeader
+    {
+        uint64_t first_sequence_number;
+        uint64_t last_sequence_number;
+        uint16_t message_count;
+        uint16_t packet_length;
+        PacketFormat format;
+        uint8_t reserved[3];
+    };
+
     struct MessageHeader
     {
         uint64_t sequence_number;
@@ -38,7 +58,8 @@ namespace mdfeed
         SNAPSHOT_BEGIN = 5,
         SNAPSHOT_ENTRY = 6,
         SNAPSHOT_END = 7,
-        BOOK_CLEAR = 8
+        BOOK_CLEAR = 8,
+        STATISTICS = 9
     };
 
     enum class Side : uint8_t
@@ -57,11 +78,14 @@ namespace mdfeed
     struct HeartbeatMessage
     {
         MessageHeader header;
+        uint32_t checksum;
+        uint8_t reserved[4];
 
         [[nodiscard]] std::string toDebugString() const
         {
             std::ostringstream oss;
-            oss << "HEARTBEAT: " << header.toDebugString();
+            oss << "HEARTBEAT: " << header.toDebugString()
+                << " checksum=" << std::hex << checksum << std::dec;
             return oss.str();
         }
     };
@@ -193,15 +217,75 @@ namespace mdfeed
         }
     };
 
+    struct StatisticsMessage
+    {
+        MessageHeader header;
+        uint64_t session_open;
+        uint64_t session_high;
+        uint64_t session_low;
+        uint64_t session_close;
+        uint64_t session_volume;
+        uint64_t session_vwap;
+        uint64_t window_open;
+        uint64_t window_high;
+        uint64_t window_low;
+        uint64_t window_close;
+        uint64_t window_volume;
+        uint64_t window_vwap;
+        uint32_t session_trade_count;
+        uint32_t window_trade_count;
+        uint32_t window_ms;
+        uint8_t reserved[4];
+
+        [[nodiscard]] std::string toDebugString() const
+        {
+            std::ostringstream oss;
+            oss << "STATISTICS: " << header.toDebugString()
+                << " session[o=" << session_open << ", h=" << session_high
+                << ", l=" << session_low << ", c=" << session_close
+                << ", vol=" << session_volume << ", vwap=" << session_vwap
+                << ", trades=" << session_trade_count << "]"
+                << " window" << window_ms << "ms[o=" << window_open << ", h=" << window_high
+                << ", l=" << window_low << ", c=" << window_close
+                << ", vol=" << window_volume << ", vwap=" << window_vwap
+                << ", trades=" << window_trade_count << "]";
+            return oss.str();
+        }
+    };
+
+    // Gap fill over TCP. The receiver sends a request for an inclusive sequence
+    // range; the server answers with a response followed by packet_count stored
+    // packets, each sized by its own PacketHeader::packet_length.
+    struct RetransmitRequest
+    {
+        uint64_t first_sequence_number;
+        uint64_t last_sequence_number;
+    };
+
+    struct RetransmitResponse
+    {
+        // sequence range the server still holds, both zero when it holds nothing
+        uint64_t first_available;
+        uint64_t last_available;
+        uint32_t packet_count;
+        uint8_t reserved[4];
+    };
+
 #pragma pack(pop)
 
     namespace message_utils
     {
         inline uint64_t get_timestamp_ns()
         {
-            return std::chrono::duration_cast<std::chrono::nanoseconds>(
-                std::chrono::high_resolution_clock::now().time_since_epoch()
-            ).count();
+            return common::TscClock::now_ns();
+        }
+
+        // Heartbeats and statistics are generated by the publisher thread and
+        // repeat the sequence number of the last message published before them.
+        inline bool repeats_sequence(uint16_t message_type)
+        {
+            return message_type == static_cast<uint16_t>(MessageType::HEARTBEAT)
+                || message_type == static_cast<uint16_t>(MessageType::STATISTICS);
         }
 
         template <typename T>
@@ -241,6 +325,7 @@ namespace mdfeed
             case MessageType::SNAPSHOT_ENTRY: return "SNAPSHOT_ENTRY";
             case MessageType::SNAPSHOT_END: return "SNAPSHOT_END";
             case MessageType::BOOK_CLEAR: return "BOOK_CLEAR";
+            case MessageType::STATISTICS: return "STATISTICS";
             default: return "UNKNOWN";
             }
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "messages/Messages.h"
+#include "publisher/TradeStatistics.h"
 
 namespace mdfeed
 {
@@ -10,10 +11,12 @@ namespace mdfeed
     private:
         PublisherT& publisher_;
         uint32_t instrument_id_;
+        TradeStatistics statistics_;
 
     public:
-        MDAdapter(uint32_t instrument_id, PublisherT& publisher)
-            : publisher_(publisher), instrument_id_(instrument_id)
+        MDAdapter(uint32_t instrument_id, PublisherT& publisher,
+                  std::chrono::milliseconds statistics_bucket_width = std::chrono::milliseconds{1000})
+            : publisher_(publisher), instrument_id_(instrument_id), statistics_(statistics_bucket_width)
         {
         }
 
@@ -35,12 +38,18 @@ namespace mdfeed
             }
         }
 
-        void notify_trade(uint64_t trade_id, uint64_t price, uint64_t quantity, bool buyer_aggressor)
+        // timestamp_ns is read once per match and shared by all of its fills; the
+        // STATISTICS messages themselves are sent by the publisher thread
+        void notify_trade(uint64_t trade_id, uint64_t price, uint64_t quantity, bool buyer_aggressor,
+                          uint64_t timestamp_ns)
         {
             Side aggressor_side = buyer_aggressor ? Side::BUY : Side::SELL;
             publisher_.publish_trade(instrument_id_, trade_id, price, quantity, aggressor_side);
+            statistics_.on_trade(price, quantity, timestamp_ns);
         }
 
+        [[nodiscard]] const TradeStatistics& statistics() const { return statistics_; }
+
         void notify_book_clear(uint32_t reason_code = 0)
         {
             publisher_.publish_book_clear(instrument_id_, reason_code);
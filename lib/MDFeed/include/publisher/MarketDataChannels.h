@@ -0,0 +1,62 @@
+#pragma once
+
+#include "MarketDataPublisher.h"
+#include "MulticastPublisherThread.h"
+#include "RetransmitServer.h"
+#include "SnapshotPublisherThread.h"
+#include "utils/PublisherConfig.h"
+#include <memory>
+#include <vector>
+
+namespace mdfeed
+{
+    // One MarketDataPublisher, MulticastPublisherThread and
+    // SnapshotPublisherThread per channel. Instruments are assigned to
+    // channels by PublisherConfig::channel_of, so books on different channels
+    // never share a ring, a sequence space, a sender or a snapshot group, and
+    // receivers join only the groups they need.
+    class MarketDataChannels
+    {
+    public:
+        // throws std::invalid_argument when instrument_channels names a channel that does not exist
+        explicit MarketDataChannels(const PublisherConfig& config = PublisherConfig{});
+        ~MarketDataChannels();
+
+        MarketDataChannels(const MarketDataChannels&) = delete;
+        MarketDataChannels& operator=(const MarketDataChannels&) = delete;
+
+        bool start();
+        void stop();
+
+        [[nodiscard]] size_t channel_count() const { return channels_.size(); }
+        [[nodiscard]] size_t channel_of(uint32_t instrument_id) const { return config_.channel_of(instrument_id); }
+
+        MarketDataPublisher& publisher_for(uint32_t instrument_id);
+        MarketDataPublisher& publisher(size_t channel) { return *channels_[channel].publisher; }
+        const MulticastPublisherThread& sender(size_t channel) const { return *channels_[channel].sender; }
+        [[nodiscard]] const PublisherConfig& channel_config(size_t channel) const { return channels_[channel].config; }
+
+        void flush_conflated();
+
+        // totals over all channels
+        [[nodiscard]] MulticastPublisherThread::Stats get_stats() const;
+        [[nodiscard]] MarketDataPublisher::Stats get_publisher_stats() const;
+        [[nodiscard]] RetransmitServer::Stats get_retransmit_stats() const;
+        [[nodiscard]] SnapshotPublisherThread::Stats get_snapshot_stats() const;
+
+    private:
+        struct Channel
+        {
+            PublisherConfig config;
+            std::unique_ptr<MarketDataPublisher> publisher;
+            std::unique_ptr<MulticastPublisherThread> sender;
+            // null when retransmission is disabled
+            std::unique_ptr<RetransmitServer> retransmit;
+            // null when snapshots are disabled
+            std::unique_ptr<SnapshotPublisherThread> snapshots;
+        };
+
+        PublisherConfig config_;
+        std::vector<Channel> channels_;
+    };
+}
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "messages/Messages.h"
+#include "utils/ConflationTable.h"
 #include "utils/RingBuffer.h"
 #include "utils/PublisherConfig.h"
+#include <functional>
 #include <memory>
+#include <new>
 
 namespace mdfeed
 {
@@ -42,13 +45,46 @@ namespace mdfeed
         std::unique_ptr<MDRingBuffer> ring_buffer_;
         uint64_t sequence_number_{1};
 
-        template <typename T>
-        bool enqueue_message(const T& message)
+        using LevelKey = ConflationTable::Key;
+
+        // latest state of every level that could not be written while the ring was full
+        ConflationTable pending_levels_;
+        uint64_t last_drain_ns_{0};
+
+        // encodes the message directly into its ring slot, or returns false if the ring is full
+        template <typename T, typename Fill>
+        bool try_emplace(MessageType type, uint64_t sequence_number, uint32_t instrument_id, Fill&& fill)
+        {
+            void* slot = ring_buffer_->claim(sizeof(T));
+            if (!slot)
+            {
+                return false;
+            }
+            T* msg = new(slot) T{};
+            message_utils::init_header(*msg, type, sequence_number, instrument_id);
+            fill(*msg);
+            ring_buffer_->commit(sizeof(T));
+            stats_.messages_published++;
+            return true;
+        }
+
+        // a dropped message still consumes its sequence number so receivers see the drop as a gap
+        template <typename T, typename Fill>
+        bool emplace_message(MessageType type, uint32_t instrument_id, Fill&& fill)
         {
-            MessageBuffer buffer(message);
-            return ring_buffer_->push(buffer);
+            const bool written = try_emplace<T>(type, sequence_number_, instrument_id, std::forward<Fill>(fill));
+            sequence_number_++;
+            if (!written)
+            {
+                stats_.messages_dropped++;
+            }
+            return written;
         }
 
+        // writes an update, or a delete when quantity is zero, without consuming a number on failure
+        bool try_write_level(const LevelKey& key, uint64_t quantity, UpdateAction action);
+        bool publish_conflated_level(const LevelKey& key, uint64_t quantity, bool existed_before);
+
     public:
         explicit MarketDataPublisher(const PublisherConfig& config = PublisherConfig{});
         ~MarketDataPublisher();
@@ -58,6 +94,27 @@ namespace mdfeed
         bool publish_trade(uint32_t, uint64_t, uint64_t, uint64_t, Side);
         bool publish_book_clear(uint32_t, uint32_t);
         MDRingBuffer* get_ring_buffer() const;
+
+        // writes pending conflated levels; returns false while some still do not fit
+        bool flush_conflated();
+
+        struct Stats
+        {
+            uint64_t messages_published = 0;
+            uint64_t messages_dropped = 0;
+            // level updates absorbed by the conflation table instead of written
+            uint64_t updates_conflated = 0;
+            // final level states written when the table drained
+            uint64_t conflated_levels_sent = 0;
+            // new levels dropped because the table already held conflation_capacity of them;
+            // also counted in messages_dropped
+            uint64_t conflation_table_full = 0;
+        };
+
+        Stats get_stats() const { return stats_; }
+
+    private:
+        Stats stats_;
     };
 
     class NullMarketDataPublisher : public MarketDataPublisherBase<NullMarketDataPublisher>
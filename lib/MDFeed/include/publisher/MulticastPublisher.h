@@ -6,6 +6,12 @@ namespace mdfeed
 {
     class MulticastSocket;
 
+    struct Datagram
+    {
+        const void* data;
+        std::size_t length;
+    };
+
     class MulticastPublisher
     {
     public:
@@ -23,6 +29,10 @@ namespace mdfeed
 
         bool send(const void* data, std::size_t length);
 
+        // hands the datagrams to the kernel in one call where the platform allows it
+        // (sendmmsg); returns how many were accepted, which may be fewer than count
+        std::size_t send_batch(const Datagram* datagrams, std::size_t count);
+
         template <typename T>
         bool send_message(const T& message)
         {
@@ -1,10 +1,19 @@
 #pragma once
 
 #include "MulticastPublisher.h"
+#include "SnapshotPublisherThread.h"
+#include "TradeStatistics.h"
+#include "utils/FeedBooks.h"
+#include "utils/PacketFraming.h"
+#include "utils/RetransmitStore.h"
 #include "utils/RingBuffer.h"
 #include "utils/PublisherConfig.h"
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <optional>
+#include <vector>
 
 namespace mdfeed
 {
@@ -22,21 +31,71 @@ namespace mdfeed
         void stop();
         bool is_running() const { return running_.load(); }
 
+        // must be set before start(); book images are refreshed for it every snapshot_interval
+        void set_snapshot_publisher(SnapshotPublisherThread* snapshots) { snapshots_ = snapshots; }
+        // must be set before start(); every incremental packet is stored in it, sent or not
+        void set_retransmit_store(RetransmitStore* store) { retransmit_store_ = store; }
+
         struct Stats
         {
             uint64_t messages_sent = 0;
+            uint64_t packets_sent = 0;
             uint64_t send_failures = 0;
             uint64_t ring_buffer_empty_count = 0;
+            uint64_t bursts_sent = 0;
+            uint64_t partial_bursts = 0;
+            uint64_t max_burst_size = 0;
+            uint64_t heartbeats_sent = 0;
+            uint64_t statistics_sent = 0;
+            // messages larger than max_packet_size on their own, never sent
+            uint64_t oversized_messages = 0;
+            // empty polls that yielded or parked rather than spun
+            uint64_t idle_parks = 0;
+
+            [[nodiscard]] double average_burst_size() const
+            {
+                return bursts_sent == 0 ? 0.0 : static_cast<double>(packets_sent) / bursts_sent;
+            }
         };
 
         Stats get_stats() const { return stats_; }
 
     private:
         void publisher_loop();
+        // pops ring entries into packet until the ring is empty or the byte budget is reached
+        void fill_packet(PacketBuilder& packet);
+        // fills up to max_burst_datagrams packets, returns how many are ready to send
+        size_t fill_burst();
+        void send_burst(size_t count);
+        // packs heartbeats repeating the last sequence number from instrument next on, returns how
+        // many packets they fill; next is left at the first instrument that did not fit, empty once
+        // all are packed. They are built here rather than by the books so idle detection costs the
+        // matching thread nothing.
+        size_t fill_heartbeats(std::optional<uint32_t>& next);
+        // packs STATISTICS from next on, also repeating the last sequence number, and returns
+        // how many packets they fill; next is left at the first instrument that did not fit
+        size_t fill_statistics(std::map<uint32_t, TradeStatistics>::const_iterator& next, uint64_t now_ns);
+        // every statistics_interval, for every instrument that has traded
+        void publish_statistics(std::chrono::steady_clock::time_point now);
+        void refresh_snapshot_images(std::chrono::steady_clock::time_point now);
 
         MDRingBuffer* ring_buffer_;
         PublisherConfig config_;
         MulticastPublisher multicast_publisher_;
+        std::vector<PacketBuilder> packets_;
+        std::vector<Datagram> datagrams_;
+        SnapshotPublisherThread* snapshots_ = nullptr;
+        RetransmitStore* retransmit_store_ = nullptr;
+        // replica of the books, kept only when heartbeat checksums or snapshots need it
+        FeedBooks books_;
+        bool track_books_ = false;
+        BookImageSet images_;
+        // rebuilt from the TRADE messages sent, only when statistics_interval is set
+        std::map<uint32_t, TradeStatistics> trade_statistics_;
+        uint64_t last_sequence_number_ = 0;
+        std::chrono::steady_clock::time_point last_send_time_;
+        std::chrono::steady_clock::time_point last_image_time_;
+        std::chrono::steady_clock::time_point last_statistics_time_;
         std::atomic<bool> running_;
         std::thread publisher_thread_;
         Stats stats_;
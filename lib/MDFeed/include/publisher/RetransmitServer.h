@@ -0,0 +1,71 @@
+#pragma once
+
+#include "utils/PublisherConfig.h"
+#include "utils/RetransmitStore.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace mdfeed
+{
+    // Answers RetransmitRequests from its store over TCP on
+    // interface_ip:retransmit_port. Runs on its own thread and only reads the
+    // store, so gap fills never hold up the sender or the matching thread.
+    // Client sockets are non-blocking, so a slow or stalled client never holds
+    // up the others: requests are assembled from whatever bytes have arrived
+    // and responses are written as the socket drains.
+    class RetransmitServer
+    {
+    public:
+        explicit RetransmitServer(const PublisherConfig& config = PublisherConfig{});
+        ~RetransmitServer();
+
+        RetransmitServer(const RetransmitServer&) = delete;
+        RetransmitServer& operator=(const RetransmitServer&) = delete;
+
+        bool start();
+        void stop();
+        bool is_running() const { return running_.load(); }
+
+        // filled by the channel's MulticastPublisherThread
+        RetransmitStore* store() { return &store_; }
+
+        struct Stats
+        {
+            uint64_t connections = 0;
+            uint64_t requests = 0;
+            uint64_t packets_resent = 0;
+            // requests for sequence numbers no longer held
+            uint64_t requests_too_old = 0;
+        };
+
+        Stats get_stats() const { return stats_; }
+
+    private:
+        struct Connection
+        {
+            int fd = -1;
+            // the request being read, complete once received reaches sizeof(RetransmitRequest)
+            RetransmitRequest request{};
+            size_t received = 0;
+            // the response being written; no further request is read until it is sent
+            std::vector<char> response;
+            size_t sent = 0;
+        };
+
+        void server_loop();
+        void accept_client();
+        // each returns false once the connection should be closed
+        bool read_request(Connection& connection);
+        bool write_response(Connection& connection);
+        void build_response(Connection& connection);
+
+        PublisherConfig config_;
+        RetransmitStore store_;
+        int listen_fd_;
+        std::vector<Connection> connections_;
+        std::atomic<bool> running_;
+        std::thread server_thread_;
+        Stats stats_;
+    };
+}
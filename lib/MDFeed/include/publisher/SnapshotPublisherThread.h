@@ -0,0 +1,65 @@
+#pragma once
+
+#include "MulticastPublisher.h"
+#include "utils/FeedBooks.h"
+#include "utils/PacketFraming.h"
+#include "utils/PublisherConfig.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace mdfeed
+{
+    // Cycles through the latest book images on the snapshot group, sending
+    // SNAPSHOT_BEGIN, one SNAPSHOT_ENTRY per level and SNAPSHOT_END for each
+    // book. Every message of a snapshot carries the incremental sequence number
+    // the image is consistent with. Images come from the channel's
+    // MulticastPublisherThread, so neither thread ever touches the books; each
+    // channel has its own thread and group, since sequence numbers are per channel.
+    class SnapshotPublisherThread
+    {
+    public:
+        explicit SnapshotPublisherThread(const PublisherConfig& config = PublisherConfig{});
+        ~SnapshotPublisherThread();
+
+        SnapshotPublisherThread(const SnapshotPublisherThread&) = delete;
+        SnapshotPublisherThread& operator=(const SnapshotPublisherThread&) = delete;
+
+        bool start();
+        void stop();
+        bool is_running() const { return running_.load(); }
+
+        // takes the channel's latest images; images share their levels, so this is cheap
+        void update_images(BookImageSet images);
+
+        struct Stats
+        {
+            uint64_t cycles = 0;
+            uint64_t snapshots_sent = 0;
+            uint64_t entries_sent = 0;
+            uint64_t packets_sent = 0;
+            uint64_t send_failures = 0;
+            // snapshot messages larger than max_packet_size on their own, never sent
+            uint64_t oversized_messages = 0;
+        };
+
+        Stats get_stats() const { return stats_; }
+
+    private:
+        void snapshot_loop();
+        void send_image(const BookImage& image);
+        void send_level(const BookImage& image, const SnapshotLevel& level, Side side);
+        template <typename T>
+        void append(const T& message);
+        void flush();
+
+        PublisherConfig config_;
+        MulticastPublisher multicast_publisher_;
+        PacketBuilder packet_;
+        std::mutex images_mutex_;
+        BookImageSet images_;
+        std::atomic<bool> running_;
+        std::thread snapshot_thread_;
+        Stats stats_;
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace mdfeed
+{
+    struct Ohlcv
+    {
+        uint64_t open = 0;
+        uint64_t high = 0;
+        uint64_t low = 0;
+        uint64_t close = 0;
+        uint64_t volume = 0;
+        uint64_t notional = 0;
+        uint32_t trade_count = 0;
+
+        void add(uint64_t price, uint64_t quantity)
+        {
+            if (trade_count == 0)
+            {
+                open = high = low = price;
+            }
+            high = price > high ? price : high;
+            low = price < low ? price : low;
+            close = price;
+            volume += quantity;
+            notional += price * quantity;
+            trade_count++;
+        }
+
+        // fold in a later period
+        void merge(const Ohlcv& later);
+
+        [[nodiscard]] uint64_t vwap() const { return volume == 0 ? 0 : notional / volume; }
+    };
+
+    struct TradeSummary
+    {
+        Ohlcv session;
+        Ohlcv window;
+        uint32_t window_ms;
+    };
+
+    // Session and rolling-window trade statistics for one instrument. Trades
+    // land in a fixed ring of time buckets, so recording a trade is O(1) and
+    // the window aggregate is only folded over the ring when it is read. The
+    // window covers the WINDOW_BUCKETS buckets up to the time it is read at,
+    // so it empties once trading stops for a whole window.
+    class TradeStatistics
+    {
+    public:
+        static constexpr size_t WINDOW_BUCKETS = 60;
+
+        explicit TradeStatistics(std::chrono::milliseconds bucket_width = std::chrono::milliseconds{1000});
+
+        void on_trade(uint64_t price, uint64_t quantity, uint64_t timestamp_ns);
+
+        // buckets older than the window ending at now_ns are left out
+        [[nodiscard]] TradeSummary summary(uint64_t now_ns) const;
+        [[nodiscard]] const Ohlcv& session() const { return session_; }
+
+    private:
+        struct Bucket
+        {
+            uint64_t index = std::numeric_limits<uint64_t>::max();
+            Ohlcv stats;
+        };
+
+        uint64_t bucket_width_ns_;
+        uint64_t current_bucket_ = std::numeric_limits<uint64_t>::max();
+        std::array<Bucket, WINDOW_BUCKETS> buckets_{};
+        Ohlcv session_;
+    };
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "MessageDispatch.h"
+#include "messages/Messages.h"
+#include "utils/BookChecksum.h"
+#include <algorithm>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace mdfeed
+{
+    struct BookLevel
+    {
+        uint64_t price = 0;
+        uint64_t quantity = 0;
+    };
+
+    // zero quantity on a side means that side is empty
+    struct Bbo
+    {
+        BookLevel bid;
+        BookLevel ask;
+    };
+
+    // One side of a book as a flat array ordered worst to best, so the touch is
+    // at the back: updates near it shift only a few elements and find their
+    // slot with a short backwards scan, deeper ones fall back to binary search.
+    class BookSide
+    {
+    public:
+        BookSide(Side side, size_t reserve_levels)
+            : side_(side)
+        {
+            levels_.reserve(reserve_levels);
+        }
+
+        // returns the previous quantity, zero if the level did not exist
+        uint64_t set(uint64_t price, uint64_t quantity)
+        {
+            const size_t index = position(price);
+            const bool exists = index < levels_.size() && levels_[index].price == price;
+            const uint64_t previous = exists ? levels_[index].quantity : 0;
+            if (quantity == 0)
+            {
+                if (exists)
+                {
+                    levels_.erase(levels_.begin() + static_cast<std::ptrdiff_t>(index));
+                }
+            }
+            else if (exists)
+            {
+                levels_[index].quantity = quantity;
+            }
+            else
+            {
+                levels_.insert(levels_.begin() + static_cast<std::ptrdiff_t>(index), BookLevel{price, quantity});
+            }
+            return previous;
+        }
+
+        void clear() { levels_.clear(); }
+
+        [[nodiscard]] BookLevel best() const { return levels_.empty() ? BookLevel{} : levels_.back(); }
+
+        [[nodiscard]] size_t depth() const { return levels_.size(); }
+
+        // copies up to out.size() levels, best first, and returns how many
+        size_t top(std::span<BookLevel> out) const
+        {
+            const size_t count = std::min(out.size(), levels_.size());
+            for (size_t i = 0; i < count; ++i)
+            {
+                out[i] = levels_[levels_.size() - 1 - i];
+            }
+            return count;
+        }
+
+    private:
+        static constexpr size_t TOUCH_SCAN = 8;
+
+        // bids get better as the price rises, asks as it falls
+        [[nodiscard]] bool better(uint64_t a, uint64_t b) const { return side_ == Side::BUY ? a > b : a < b; }
+
+        // index of the level at price, or where it would be inserted
+        [[nodiscard]] size_t position(uint64_t price) const
+        {
+            size_t index = levels_.size();
+            for (size_t scanned = 0; scanned < TOUCH_SCAN && index > 0; ++scanned)
+            {
+                if (!better(levels_[index - 1].price, price))
+                {
+                    return levels_[index - 1].price == price ? index - 1 : index;
+                }
+                --index;
+            }
+            const auto it = std::lower_bound(levels_.begin(), levels_.begin() + static_cast<std::ptrdiff_t>(index),
+                                             price, [this](const BookLevel& level, uint64_t p)
+                                             {
+                                                 return better(p, level.price);
+                                             });
+            return static_cast<size_t>(it - levels_.begin());
+        }
+
+        Side side_;
+        std::vector<BookLevel> levels_;
+    };
+
+    // Rebuilds L2 books from the feed. Usable directly as the Handler of a
+    // BasicMulticastReceiver, or fed from another handler's callbacks.
+    // Snapshots replace a book only when they are newer than what has been
+    // applied, and incrementals the image already reflects are skipped, so the
+    // builder can listen to the incremental and snapshot groups at once.
+    // Queries never allocate; updates allocate only for a new instrument or a
+    // side deeper than reserve_levels.
+    class BookBuilder
+    {
+    public:
+        explicit BookBuilder(size_t reserve_levels = 64)
+            : reserve_levels_(reserve_levels)
+        {
+        }
+
+        void on_price_level_update(const PriceLevelUpdateMessage& msg)
+        {
+            apply_level(msg.header, msg.side, msg.price, msg.quantity);
+        }
+
+        void on_price_level_delete(const PriceLevelDeleteMessage& msg)
+        {
+            apply_level(msg.header, msg.side, msg.price, 0);
+        }
+
+        void on_book_clear(const BookClearMessage& msg)
+        {
+            Book& book = book_for(msg.header.instrument_id);
+            if (msg.header.sequence_number <= book.sequence_number)
+            {
+                return;
+            }
+            clear(book);
+            book.sequence_number = msg.header.sequence_number;
+        }
+
+        void on_snapshot_begin(const SnapshotBeginMessage& msg)
+        {
+            Book& book = book_for(msg.header.instrument_id);
+            // an image no newer than the book would only rewind it
+            book.applying_snapshot = !book.consistent || msg.header.sequence_number > book.sequence_number;
+            if (book.applying_snapshot)
+            {
+                clear(book);
+                book.consistent = false;
+            }
+        }
+
+        void on_snapshot_entry(const SnapshotEntryMessage& msg)
+        {
+            Book& book = book_for(msg.header.instrument_id);
+            if (book.applying_snapshot)
+            {
+                set_level(book, msg.side, msg.price, msg.quantity);
+            }
+        }
+
+        void on_snapshot_end(const SnapshotEndMessage& msg)
+        {
+            Book& book = book_for(msg.header.instrument_id);
+            if (!book.applying_snapshot)
+            {
+                return;
+            }
+            book.applying_snapshot = false;
+            book.sequence_number = msg.header.sequence_number;
+            book.consistent = book.checksum.value() == msg.checksum;
+            if (book.consistent)
+            {
+                stats_.snapshots_applied++;
+            }
+            else
+            {
+                stats_.checksum_mismatches++;
+            }
+        }
+
+        // heartbeats carry the publisher's checksum for each book, as of their sequence number
+        void on_heartbeat(const HeartbeatMessage& msg)
+        {
+            const auto it = books_.find(msg.header.instrument_id);
+            if (it != books_.end() && !it->second.applying_snapshot
+                && it->second.sequence_number <= msg.header.sequence_number
+                && it->second.checksum.value() != msg.checksum)
+            {
+                it->second.consistent = false;
+                stats_.checksum_mismatches++;
+            }
+        }
+
+        void on_feed_state(FeedState state) { feed_state_ = state; }
+
+        [[nodiscard]] FeedState feed_state() const { return feed_state_; }
+
+        [[nodiscard]] Bbo bbo(uint32_t instrument_id) const
+        {
+            const Book* book = find(instrument_id);
+            return book ? Bbo{book->bids.best(), book->asks.best()} : Bbo{};
+        }
+
+        // up to out.size() levels of one side, best first; returns how many were written
+        size_t top_levels(uint32_t instrument_id, Side side, std::span<BookLevel> out) const
+        {
+            const Book* book = find(instrument_id);
+            return book ? side_of(*book, side).top(out) : 0;
+        }
+
+        [[nodiscard]] size_t depth(uint32_t instrument_id, Side side) const
+        {
+            const Book* book = find(instrument_id);
+            return book ? side_of(*book, side).depth() : 0;
+        }
+
+        [[nodiscard]] uint32_t checksum(uint32_t instrument_id) const
+        {
+            const Book* book = find(instrument_id);
+            return book ? book->checksum.value() : 0;
+        }
+
+        // the feed sequence number the book is consistent with
+        [[nodiscard]] uint64_t sequence_number(uint32_t instrument_id) const
+        {
+            const Book* book = find(instrument_id);
+            return book ? book->sequence_number : 0;
+        }
+
+        // false while a snapshot is being applied, after a checksum mismatch until a
+        // good snapshot, and while the feed is not LIVE
+        [[nodiscard]] bool is_consistent(uint32_t instrument_id) const
+        {
+            const Book* book = find(instrument_id);
+            return book && book->consistent && !book->applying_snapshot && feed_state_ == FeedState::LIVE;
+        }
+
+        // fn(uint32_t instrument_id) for every book seen so far
+        template <typename Fn>
+        void for_each_instrument(Fn&& fn) const
+        {
+            for (const auto& [instrument_id, book] : books_)
+            {
+                fn(instrument_id);
+            }
+        }
+
+        struct Stats
+        {
+            uint64_t updates_applied = 0;
+            // incrementals already reflected in a snapshot image
+            uint64_t stale_updates_skipped = 0;
+            uint64_t snapshots_applied = 0;
+            uint64_t checksum_mismatches = 0;
+        };
+
+        [[nodiscard]] Stats get_stats() const { return stats_; }
+
+    private:
+        struct Book
+        {
+            explicit Book(size_t reserve_levels)
+                : bids(Side::BUY, reserve_levels)
+                  , asks(Side::SELL, reserve_levels)
+            {
+            }
+
+            BookSide bids;
+            BookSide asks;
+            BookChecksum checksum;
+            uint64_t sequence_number = 0;
+            bool consistent = true;
+            bool applying_snapshot = false;
+        };
+
+        static const BookSide& side_of(const Book& book, Side side)
+        {
+            return side == Side::BUY ? book.bids : book.asks;
+        }
+
+        [[nodiscard]] const Book* find(uint32_t instrument_id) const
+        {
+            const auto it = books_.find(instrument_id);
+            return it == books_.end() ? nullptr : &it->second;
+        }
+
+        Book& book_for(uint32_t instrument_id)
+        {
+            if (last_book_ && last_instrument_id_ == instrument_id)
+            {
+                return *last_book_;
+            }
+            // node-based, so the cached pointer survives later insertions
+            last_book_ = &books_.try_emplace(instrument_id, reserve_levels_).first->second;
+            last_instrument_id_ = instrument_id;
+            return *last_book_;
+        }
+
+        void apply_level(const MessageHeader& header, Side side, uint64_t price, uint64_t quantity)
+        {
+            Book& book = book_for(header.instrument_id);
+            if (header.sequence_number <= book.sequence_number)
+            {
+                stats_.stale_updates_skipped++;
+                return;
+            }
+            set_level(book, side, price, quantity);
+            book.sequence_number = header.sequence_number;
+            stats_.updates_applied++;
+        }
+
+        static void set_level(Book& book, Side side, uint64_t price, uint64_t quantity)
+        {
+            BookSide& levels = side == Side::BUY ? book.bids : book.asks;
+            const uint64_t previous = levels.set(price, quantity);
+            book.checksum.update(side, price, previous, quantity);
+        }
+
+        static void clear(Book& book)
+        {
+            book.bids.clear();
+            book.asks.clear();
+            book.checksum.reset();
+        }
+
+        size_t reserve_levels_;
+        std::unordered_map<uint32_t, Book> books_;
+        uint32_t last_instrument_id_ = 0;
+        Book* last_book_ = nullptr;
+        FeedState feed_state_ = FeedState::LIVE;
+        Stats stats_;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace mdfeed {
+    // One classic BPF instruction, laid out as Linux's struct sock_filter.
+    struct BpfInstruction {
+        uint16_t code;
+        uint8_t jt;
+        uint8_t jf;
+        uint32_t k;
+    };
+
+    // Compiles a socket filter for a multicast receive socket that keeps a
+    // plain packet only if one of its messages is for an instrument in
+    // instrument_ids. Compact packets are always kept, their instrument ids
+    // are delta encoded. Returns an empty program when there is nothing to
+    // filter on, on platforms without socket filters, or when the list is too
+    // long for one program; the caller then receives everything.
+    std::vector<BpfInstruction> compile_instrument_filter(std::span<const uint32_t> instrument_ids);
+} // namespace mdfeed
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include <functional>
+
+namespace mdfeed {
+    using MessageHandler = std::function<void(const MessageHeader&,
+                                              const void* data, size_t length)>;
+
+    // Whether the messages a handler has seen add up to the publisher's state.
+    enum class FeedState : uint8_t {
+        // every message up to the latest has been delivered
+        LIVE,
+        // a gap is being filled; newer messages are held back and delivered once it is
+        RECOVERING,
+        // the gap could not be filled in time, handler state is missing messages
+        // until a snapshot cycle brings it back to LIVE
+        STALE
+    };
+
+    // Calls the handler's typed callback for the message, e.g.
+    // on_price_level_update(const PriceLevelUpdateMessage&). Callbacks are
+    // optional: a message whose type has no callback, or that is too short for
+    // its type, goes to on_message(header, data, length) if the handler has it
+    // and is ignored otherwise. Everything resolves at compile time.
+    template <typename Handler>
+    void dispatch_message(Handler& handler, const MessageHeader& header, const void* data, size_t length)
+    {
+        switch (static_cast<MessageType>(header.message_type))
+        {
+        case MessageType::HEARTBEAT:
+            if constexpr (requires(const HeartbeatMessage& m) { handler.on_heartbeat(m); })
+            {
+                if (length >= sizeof(HeartbeatMessage))
+                {
+                    handler.on_heartbeat(*static_cast<const HeartbeatMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::PRICE_LEVEL_UPDATE:
+            if constexpr (requires(const PriceLevelUpdateMessage& m) { handler.on_price_level_update(m); })
+            {
+                if (length >= sizeof(PriceLevelUpdateMessage))
+                {
+                    handler.on_price_level_update(*static_cast<const PriceLevelUpdateMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::PRICE_LEVEL_DELETE:
+            if constexpr (requires(const PriceLevelDeleteMessage& m) { handler.on_price_level_delete(m); })
+            {
+                if (length >= sizeof(PriceLevelDeleteMessage))
+                {
+                    handler.on_price_level_delete(*static_cast<const PriceLevelDeleteMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::TRADE:
+            if constexpr (requires(const TradeMessage& m) { handler.on_trade(m); })
+            {
+                if (length >= sizeof(TradeMessage))
+                {
+                    handler.on_trade(*static_cast<const TradeMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::SNAPSHOT_BEGIN:
+            if constexpr (requires(const SnapshotBeginMessage& m) { handler.on_snapshot_begin(m); })
+            {
+                if (length >= sizeof(SnapshotBeginMessage))
+                {
+                    handler.on_snapshot_begin(*static_cast<const SnapshotBeginMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::SNAPSHOT_ENTRY:
+            if constexpr (requires(const SnapshotEntryMessage& m) { handler.on_snapshot_entry(m); })
+            {
+                if (length >= sizeof(SnapshotEntryMessage))
+                {
+                    handler.on_snapshot_entry(*static_cast<const SnapshotEntryMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::SNAPSHOT_END:
+            if constexpr (requires(const SnapshotEndMessage& m) { handler.on_snapshot_end(m); })
+            {
+                if (length >= sizeof(SnapshotEndMessage))
+                {
+                    handler.on_snapshot_end(*static_cast<const SnapshotEndMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::BOOK_CLEAR:
+            if constexpr (requires(const BookClearMessage& m) { handler.on_book_clear(m); })
+            {
+                if (length >= sizeof(BookClearMessage))
+                {
+                    handler.on_book_clear(*static_cast<const BookClearMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        case MessageType::STATISTICS:
+            if constexpr (requires(const StatisticsMessage& m) { handler.on_statistics(m); })
+            {
+                if (length >= sizeof(StatisticsMessage))
+                {
+                    handler.on_statistics(*static_cast<const StatisticsMessage*>(data));
+                    return;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+        if constexpr (requires { handler.on_message(header, data, length); })
+        {
+            handler.on_message(header, data, length);
+        }
+    }
+
+    // Tells the handler the feed changed state, if it has on_feed_state(FeedState).
+    template <typename Handler>
+    void dispatch_feed_state(Handler& handler, FeedState state)
+    {
+        if constexpr (requires { handler.on_feed_state(state); })
+        {
+            handler.on_feed_state(state);
+        }
+    }
+
+    // Adapter that hands every message to a MessageHandler, for callers that
+    // prefer a std::function and do their own switch on message_type.
+    struct FunctionMessageHandler {
+        MessageHandler handler;
+
+        void on_message(const MessageHeader& header, const void* data, size_t length) const
+        {
+            if (handler)
+            {
+                handler(header, data, length);
+            }
+        }
+    };
+} // namespace mdfeed
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include "utils/RingBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace mdfeed
+{
+    // Asynchronous receiver log. The receiver thread copies raw messages and
+    // its own notes into a byte ring and returns; a background thread formats
+    // them, writes them to the console and/or the log file, and flushes once
+    // per drain rather than once per line. A full ring drops entries, it never
+    // blocks the receiver.
+    class MessageJournal
+    {
+    public:
+        MessageJournal(bool to_console, const std::string& file_path, size_t buffer_bytes,
+                       std::chrono::milliseconds flush_interval);
+        ~MessageJournal();
+
+        MessageJournal(const MessageJournal&) = delete;
+        MessageJournal& operator=(const MessageJournal&) = delete;
+
+        // false if the log file could not be opened
+        [[nodiscard]] bool is_open() const { return file_path_.empty() || file_.is_open(); }
+
+        void start();
+        // writes everything still in the ring before returning
+        void stop();
+
+        // producer thread only
+        void record(const void* message, size_t length);
+        void record_text(std::string_view text);
+
+        // any other thread; written directly, in order with the drained entries
+        void write_line(const std::string& line);
+
+        [[nodiscard]] uint64_t dropped_entries() const { return dropped_.load(std::memory_order_relaxed); }
+
+        static std::string format_message(const MessageHeader& header, const void* data);
+
+    private:
+        enum class EntryKind : uint64_t
+        {
+            MESSAGE,
+            TEXT
+        };
+
+        void append(EntryKind kind, const void* data, size_t length);
+        void writer_loop();
+        // formats and writes every entry in the ring, returns false if it was empty
+        bool drain();
+        void write(const std::string& text);
+
+        bool to_console_;
+        std::string file_path_;
+        std::ofstream file_;
+        ByteRing ring_;
+        std::chrono::milliseconds flush_interval_;
+        std::string batch_;
+        std::mutex output_mutex_;
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<bool> running_{false};
+        std::thread writer_thread_;
+    };
+}
@@ -1,67 +1,514 @@
 #pragma once
 
 #include "ReceiverConfig.h"
+#include "MessageDispatch.h"
+#include "MessageJournal.h"
+#include "RecoveryQueue.h"
 #include "messages/Messages.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/PacketFraming.h"
+#include "utils/WaitStrategy.h"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <concepts>
 #include <functional>
 #include <memory>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace mdfeed {
-    class MulticastSocket;
+    // distinct from the publisher's MulticastSocket, both are defined in their .cpp files
+    class MulticastReceiveSocket;
+    class RetransmitClient;
+    template <typename Handler>
+    class MulticastReceiverGroup;
 
-    using MessageHandler = std::function<void(const MessageHeader&,
-                                              const void* data, size_t length)>;
-
-    class MulticastReceiver {
+    // Socket, journal, gap recovery and statistics shared by every
+    // BasicMulticastReceiver, independent of the handler type.
+    class MulticastReceiverBase {
     public:
-        MulticastReceiver();
-        explicit MulticastReceiver(const ReceiverConfig& config);
-        ~MulticastReceiver();
-
-        MulticastReceiver(const MulticastReceiver&) = delete;
-        MulticastReceiver& operator=(const MulticastReceiver&) = delete;
+        MulticastReceiverBase(const MulticastReceiverBase&) = delete;
+        MulticastReceiverBase& operator=(const MulticastReceiverBase&) = delete;
 
         bool initialize(const ReceiverConfig& config);
-        bool start();
         void stop();
         bool is_running() const { return running_.load(); }
+        FeedState feed_state() const { return state_.load(std::memory_order_relaxed); }
 
-        void set_message_handler(MessageHandler handler)
-        {
-            message_handler_ = std::move(handler);
-        }
+        // pins the calling thread, false if the CPU is unavailable or pinning unsupported
+        static bool pin_current_thread(int cpu);
 
         struct Stats {
             uint64_t total_messages_received = 0;
+            uint64_t total_packets_received = 0;
             uint64_t total_bytes_received = 0;
             uint64_t sequence_gaps = 0;
+            // gap messages filled from the retransmit server
+            uint64_t messages_recovered = 0;
+            // gap fill requests that came back incomplete
+            uint64_t recovery_failures = 0;
+            // gaps that held the feed back in RECOVERING
+            uint64_t recoveries = 0;
+            // recoveries completed from a snapshot cycle rather than retransmission
+            uint64_t snapshot_recoveries = 0;
+            // held-back messages delivered once recovery ended
+            uint64_t messages_replayed = 0;
+            uint64_t stale_transitions = 0;
+            uint64_t heartbeats_received = 0;
             uint64_t invalid_messages = 0;
+            // messages for instruments outside ReceiverConfig::instruments that got past the socket filter
+            uint64_t filtered_messages = 0;
+            // receive calls that returned at least one datagram
+            uint64_t receive_batches = 0;
+            uint64_t max_batch_size = 0;
+            // journal entries lost because its ring was full
+            uint64_t log_entries_dropped = 0;
+            // header timestamp to kernel arrival, per message; includes any clock offset between hosts
+            LatencySummary publish_to_wire;
+            // kernel arrival to the receiver thread picking the datagram up
+            LatencySummary wire_to_user;
             std::chrono::steady_clock::time_point start_time;
+
+            [[nodiscard]] double average_batch_size() const
+            {
+                return receive_batches == 0 ? 0.0 : static_cast<double>(total_packets_received) / receive_batches;
+            }
         };
 
-        Stats get_stats() const { return stats_; }
+        Stats get_stats() const;
         void reset_stats();
 
-    private:
-        void receiver_loop();
-        void process_message(const void* data, size_t length);
+    protected:
+        MulticastReceiverBase();
+        ~MulticastReceiverBase();
+
+        // checks the socket, starts the journal and the stats thread; the caller starts receiver_thread_
+        bool begin_start();
+        // prepares the datagram buffers and logs the start, on the receiver thread
+        void begin_receiving();
+        // up to receive_batch_size datagrams, see MulticastReceiveSocket::receive_batch
+        int receive_batch();
+        // the same from the snapshot group, never blocks; -1 without a snapshot socket
+        int receive_snapshot_batch();
+        // false if the timeout passed with no incremental datagram waiting; also
+        // returns early when snapshot data or the gap fill reply arrives so it can be read promptly
+        bool wait_for_datagrams(std::chrono::milliseconds timeout);
+        // the datagrams of the last receive_batch or receive_snapshot_batch
+        [[nodiscard]] const char* datagram(size_t i) const;
+        [[nodiscard]] size_t datagram_length(size_t i) const;
+        [[nodiscard]] bool datagram_truncated(size_t i) const;
+        // 0 without kernel timestamps
+        [[nodiscard]] uint64_t datagram_receive_time(size_t i) const;
+
+        // false, counted and logged, if the message is too short or its length field disagrees
+        bool check_message(const void* data, size_t length);
+
+        struct Gap {
+            uint64_t first = 0;
+            uint64_t last = 0;
+
+            [[nodiscard]] bool empty() const { return first == 0; }
+        };
+
+        // counts and logs a sequence gap before header; returns the range to recover, empty if none
+        Gap check_sequence(const MessageHeader& header);
+        // marks header as the latest message delivered
+        void accept_sequence(const MessageHeader& header);
+
+        // Gap recovery. A gap moves the feed to RECOVERING: later messages go to
+        // recovery_queue_ instead of the handler while the gap is requested from
+        // the retransmit server and the snapshot group is read. The queue is
+        // released once the gap is filled, once a whole snapshot cycle at or
+        // after required_sequence_ has been delivered, or when recovery is given up.
+
+        // only from LIVE, and only with a retransmit or snapshot source
+        [[nodiscard]] bool can_recover() const;
+        void begin_recovery(const Gap& missing);
+        // true if the message was queued or dropped rather than to be delivered now
+        bool hold_message(const MessageHeader& header, const void* data, size_t length);
+        // true when the remaining gap should be requested again, at most every RETRANSMIT_RETRY_INTERVAL
+        bool retransmit_due();
+        // Starts a gap fill when one is due and advances the one in flight without
+        // blocking; on_packet gets each packet of the reply, and delivers up to
+        // fill_gap_.last in order, counting them in fill_recovered_.
+        void service_gap_fill(const std::function<void(const void*, size_t)>& on_packet);
+        void finish_gap(const Gap& gap, uint64_t recovered, bool answered);
+        void update_gap(const Gap& missing);
+        // moves RECOVERING to STALE after recovery_timeout
+        void check_recovery_timeout();
+
+        enum class SnapshotStep {
+            SKIP,
+            DELIVER,
+            // header starts the next cycle; it and the rest of its datagram are not delivered
+            COMPLETE
+        };
+
+        // tracks whole images on the snapshot group; only call it while awaiting_snapshot()
+        SnapshotStep track_snapshot(const MessageHeader& header);
+        [[nodiscard]] bool awaiting_snapshot() const;
+
+        // the queue is to be delivered, then finish_release
+        [[nodiscard]] bool release_pending() const { return release_queue_; }
+        void finish_release();
+
+        static constexpr std::chrono::milliseconds RETRANSMIT_RETRY_INTERVAL{500};
+        // how long the receiver thread waits for data while recovering before it services recovery again
+        static constexpr std::chrono::milliseconds RECOVERY_POLL_INTERVAL{10};
+
+        // receiver thread only
         void log_message(const std::string& message) const;
         void print_stats();
-        static std::string format_message_debug(const MessageHeader& header,
-                                                const void* data);
+        static std::string format_latency(const LatencySummary& latency);
+
+        // -1 until initialize succeeds
+        [[nodiscard]] int socket_fd() const;
+
+        [[nodiscard]] bool subscribed(uint32_t instrument_id) const
+        {
+            return instruments_.empty() || std::binary_search(instruments_.begin(), instruments_.end(), instrument_id);
+        }
 
         ReceiverConfig config_;
-        std::unique_ptr<MulticastSocket> socket_;
+        std::unique_ptr<MulticastReceiveSocket> socket_;
+        // null unless snapshot recovery is enabled
+        std::unique_ptr<MulticastReceiveSocket> snapshot_socket_;
+        MulticastReceiveSocket* batch_socket_ = nullptr;
+        std::unique_ptr<RetransmitClient> retransmit_;
+        // config_.instruments sorted, empty to receive everything
+        std::vector<uint32_t> instruments_;
         std::atomic<bool> running_;
         std::thread receiver_thread_;
         std::thread stats_thread_;
 
-        MessageHandler message_handler_;
         Stats stats_;
+        // recorded on the receiver thread, summarised by print_stats and get_stats from others
+        LatencyHistogram publish_to_wire_;
+        LatencyHistogram wire_to_user_;
         uint64_t last_sequence_number_;
         std::chrono::steady_clock::time_point last_stats_time_;
 
-        std::unique_ptr<std::ofstream> log_file_;
+        std::atomic<FeedState> state_{FeedState::LIVE};
+        RecoveryQueue recovery_queue_;
+        // still missing and retried over retransmission while the queue follows it without a hole
+        Gap recovery_gap_;
+        // the range of the gap fill in flight and the messages it has delivered so far
+        Gap fill_gap_;
+        uint64_t fill_recovered_ = 0;
+        bool queue_contiguous_ = false;
+        // snapshots older than this do not cover the gap
+        uint64_t required_sequence_ = 0;
+        uint64_t queued_last_ = 0;
+        bool release_queue_ = false;
+        FeedState release_state_ = FeedState::LIVE;
+        std::chrono::steady_clock::time_point recovery_deadline_;
+        std::chrono::steady_clock::time_point next_retransmit_;
+        bool snapshot_cycle_started_ = false;
+        bool snapshot_image_open_ = false;
+        uint32_t snapshot_first_instrument_ = 0;
+
+        // null when logging is disabled; a MulticastReceiverGroup shares one between its channels
+        std::shared_ptr<MessageJournal> journal_;
+
+    private:
+        // the queue goes to the handler at the next settle, then the feed is in next
+        void release(FeedState next);
+        // delivers the queue as STALE; without snapshots nothing can make the feed consistent again
+        void give_up_recovery(const char* reason);
+        void mark_stale();
     };
+
+    // Receives the feed on its own thread and hands each message to Handler
+    // through dispatch_message, so the per-message call is a switch the
+    // compiler can inline rather than a std::function. Handler is owned by
+    // the receiver and only touched from the receiver thread once started;
+    // a pointer Handler forwards to a handler owned elsewhere.
+    template <typename Handler>
+    class BasicMulticastReceiver : public MulticastReceiverBase {
+        template <typename>
+        friend class MulticastReceiverGroup;
+
+    public:
+        explicit BasicMulticastReceiver(Handler handler = Handler{})
+            : handler_(std::move(handler))
+        {
+        }
+
+        explicit BasicMulticastReceiver(const ReceiverConfig& config, Handler handler = Handler{})
+            : BasicMulticastReceiver(std::move(handler))
+        {
+            initialize(config);
+        }
+
+        ~BasicMulticastReceiver()
+        {
+            // the receiver thread uses handler_, so it must stop before handler_ is destroyed
+            stop();
+        }
+
+        bool start()
+        {
+            if (!begin_start())
+            {
+                return false;
+            }
+            receiver_thread_ = std::thread(&BasicMulticastReceiver::receiver_loop, this);
+            return true;
+        }
+
+        Handler& handler() { return handler_; }
+
+        void set_message_handler(MessageHandler handler)
+            requires std::same_as<Handler, FunctionMessageHandler>
+        {
+            handler_.handler = std::move(handler);
+        }
+
+    private:
+        void receiver_loop()
+        {
+            begin_receiving();
+            while (running_.load(std::memory_order_relaxed))
+            {
+                const bool live = feed_state() == FeedState::LIVE;
+                if (!live)
+                {
+                    service_recovery();
+                }
+                // while recovering, wake up regularly to read snapshots and retry the gap fill
+                const int received = live || wait_for_datagrams(RECOVERY_POLL_INTERVAL) ? receive_batch() : 0;
+                if (received > 0)
+                {
+                    process_batch(received);
+                }
+                else if (received == 0)
+                {
+                    // a non-blocking socket came back empty, or the recovery wait timed out
+                    cpu_relax();
+                }
+                else
+                {
+                    if (running_.load())
+                    {
+                        log_message("Error receiving data from multicast socket");
+                    }
+                    break;
+                }
+            }
+            log_message("MulticastReceiver stopped");
+        }
+
+        // One pass over a non-blocking socket for a caller that runs the loop
+        // itself: services recovery, then handles the datagrams waiting.
+        // Returns how many there were, or -1 after a socket error.
+        int poll_once()
+        {
+            if (feed_state() != FeedState::LIVE)
+            {
+                service_recovery();
+            }
+            const int received = receive_batch();
+            if (received > 0)
+            {
+                process_batch(received);
+            }
+            else if (received < 0 && running_.load())
+            {
+                log_message("Error receiving data from multicast socket");
+            }
+            return received;
+        }
+
+        void process_batch(int received)
+        {
+            stats_.receive_batches++;
+            stats_.max_batch_size = std::max<uint64_t>(stats_.max_batch_size, received);
+            for (int i = 0; i < received; ++i)
+            {
+                if (datagram_truncated(i))
+                {
+                    stats_.invalid_messages++;
+                    log_message("Received oversized datagram, dropped");
+                }
+                else
+                {
+                    process_packet(datagram(i), datagram_length(i), datagram_receive_time(i));
+                }
+                stats_.total_packets_received++;
+                stats_.total_bytes_received += datagram_length(i);
+            }
+        }
+
+        void process_packet(const void* data, size_t length, uint64_t receive_time)
+        {
+            if (receive_time != 0)
+            {
+                // the kernel's clock, not the TSC, so both ends come from the same source
+                const auto now = std::chrono::system_clock::now().time_since_epoch();
+                wire_to_user_.record(elapsed_ns(receive_time, static_cast<uint64_t>(
+                                                    std::chrono::duration_cast<std::chrono::nanoseconds>(now).count())));
+            }
+            const bool valid = for_each_message(data, length,
+                                                [this, receive_time](const MessageHeader& header, const void* message,
+                                                                     size_t message_length)
+                                                {
+                                                    if (receive_time != 0)
+                                                    {
+                                                        publish_to_wire_.record(
+                                                            elapsed_ns(header.timestamp_ns, receive_time));
+                                                    }
+                                                    process_message(message, message_length);
+                                                    stats_.total_messages_received++;
+                                                });
+            if (!valid)
+            {
+                stats_.invalid_messages++;
+                log_message("Received malformed packet (" + std::to_string(length) + " bytes)");
+            }
+        }
+
+        void process_message(const void* data, size_t length)
+        {
+            if (!check_message(data, length))
+            {
+                return;
+            }
+            const auto& header = *static_cast<const MessageHeader*>(data);
+            if (!subscribed(header.instrument_id))
+            {
+                stats_.filtered_messages++;
+                return;
+            }
+            const bool held = hold_message(header, data, length);
+            settle();
+            if (held)
+            {
+                return;
+            }
+            if (const Gap gap = check_sequence(header); !gap.empty() && can_recover())
+            {
+                // the gap fill goes out from service_recovery, and this message waits for it in the queue
+                begin_recovery(gap);
+                hold_message(header, data, length);
+                settle();
+                return;
+            }
+            accept_sequence(header);
+            deliver(header, data, length);
+        }
+
+        void deliver(const MessageHeader& header, const void* data, size_t length)
+        {
+            if (journal_)
+            {
+                journal_->record(data, length);
+            }
+            dispatch_message(target(), header, data, length);
+        }
+
+        // delivers a retransmitted packet in order up to the first message still missing
+        void recover_packet(const void* packet, size_t length)
+        {
+            for_each_message(packet, length, [this](const MessageHeader& header, const void* message,
+                                                    size_t message_length)
+            {
+                // stored packets can start before the gap, and heartbeats repeat a number
+                if (header.sequence_number != last_sequence_number_ + 1 || header.sequence_number > fill_gap_.last)
+                {
+                    return;
+                }
+                last_sequence_number_ = header.sequence_number;
+                deliver(header, message, message_length);
+                fill_recovered_++;
+            });
+        }
+
+        // advances the gap fill, applies the snapshot group and gives up on time, between receive batches
+        void service_recovery()
+        {
+            if (retransmit_)
+            {
+                service_gap_fill([this](const void* packet, size_t length) { recover_packet(packet, length); });
+                settle();
+            }
+            if (snapshot_socket_)
+            {
+                int received = 0;
+                while (awaiting_snapshot() && (received = receive_snapshot_batch()) > 0)
+                {
+                    for (int i = 0; i < received; ++i)
+                    {
+                        if (!datagram_truncated(i))
+                        {
+                            for_each_message(datagram(i), datagram_length(i),
+                                             [this](const MessageHeader&, const void* message, size_t length)
+                                             {
+                                                 process_snapshot_message(message, length);
+                                             });
+                        }
+                    }
+                }
+                settle();
+            }
+            check_recovery_timeout();
+            settle();
+        }
+
+        void process_snapshot_message(const void* data, size_t length)
+        {
+            if (!awaiting_snapshot() || !check_message(data, length))
+            {
+                return;
+            }
+            const auto& header = *static_cast<const MessageHeader*>(data);
+            if (track_snapshot(header) == SnapshotStep::DELIVER)
+            {
+                deliver(header, data, length);
+            }
+        }
+
+        // delivers the held-back messages once recovery has released them and
+        // tells the handler about any change of state
+        void settle()
+        {
+            if (release_pending())
+            {
+                recovery_queue_.for_each([this](const MessageHeader& header, const void* data, size_t length)
+                {
+                    accept_sequence(header);
+                    deliver(header, data, length);
+                });
+                finish_release();
+            }
+            if (const FeedState state = feed_state(); state != notified_state_)
+            {
+                notified_state_ = state;
+                dispatch_feed_state(target(), state);
+            }
+        }
+
+        auto& target()
+        {
+            if constexpr (std::is_pointer_v<Handler>)
+            {
+                return *handler_;
+            }
+            else
+            {
+                return handler_;
+            }
+        }
+
+        // clocks on two hosts, or the TSC and the kernel clock, can disagree by more than the latency
+        static uint64_t elapsed_ns(uint64_t from, uint64_t to) { return to > from ? to - from : 0; }
+
+        Handler handler_;
+        FeedState notified_state_ = FeedState::LIVE;
+    };
+
+    // The std::function form: set_message_handler takes any callable and sees every message.
+    using MulticastReceiver = BasicMulticastReceiver<FunctionMessageHandler>;
 } // namespace mdfeed
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "MulticastReceiver.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+struct epoll_event;
+
+namespace mdfeed {
+    // Level-triggered epoll set over socket descriptors, each tagged with an index.
+    class ReadySet {
+    public:
+        ReadySet();
+        ~ReadySet();
+
+        ReadySet(const ReadySet&) = delete;
+        ReadySet& operator=(const ReadySet&) = delete;
+
+        bool add(int fd, uint32_t index);
+        // indexes of the descriptors with data waiting, empty once timeout passes
+        std::span<const uint32_t> wait(std::chrono::milliseconds timeout);
+
+    private:
+        int epoll_fd_;
+        std::unique_ptr<epoll_event[]> events_;
+        std::vector<uint32_t> ready_;
+    };
+
+    // Receives several channels on one thread. Each channel keeps its own
+    // socket, sequence tracking, gap recovery and statistics, exactly as a
+    // BasicMulticastReceiver; the group drives them from a single epoll loop,
+    // or spins over every socket with busy_poll, and they all deliver to the
+    // one Handler it owns. Logging goes to one shared journal and statistics
+    // are printed from the loop, so the only other thread is the journal
+    // writer.
+    template <typename Handler>
+    class MulticastReceiverGroup {
+    public:
+        // config supplies the group-wide settings: busy_poll, receiver_cpu,
+        // stats_interval and logging. Channel addresses come from add_channel.
+        explicit MulticastReceiverGroup(const ReceiverConfig& config, Handler handler = Handler{})
+            : config_(config)
+              , handler_(std::move(handler))
+              , running_(false)
+        {
+            if (config_.enable_logging)
+            {
+                journal_ = std::make_shared<MessageJournal>(config_.log_to_console, config_.log_file_path,
+                                                            config_.journal_buffer_bytes,
+                                                            config_.journal_flush_interval);
+            }
+        }
+
+        ~MulticastReceiverGroup()
+        {
+            stop();
+        }
+
+        MulticastReceiverGroup(const MulticastReceiverGroup&) = delete;
+        MulticastReceiverGroup& operator=(const MulticastReceiverGroup&) = delete;
+
+        // Joins a channel before start(). Only its group, port, sequence and
+        // recovery settings are used. Returns the channel's index, or -1.
+        int add_channel(ReceiverConfig config)
+        {
+            if (running_.load() || (journal_ && !journal_->is_open()))
+            {
+                return -1;
+            }
+            config.enable_logging = false;
+            // every socket is drained without blocking, whether by epoll or by spinning
+            config.busy_poll = true;
+            config.receiver_cpu = -1;
+            auto channel = std::make_unique<Channel>(&handler_);
+            const auto index = static_cast<uint32_t>(channels_.size());
+            if (!channel->initialize(config) || !ready_.add(channel->socket_fd(), index))
+            {
+                return -1;
+            }
+            channel->journal_ = journal_;
+            channels_.push_back(std::move(channel));
+            return static_cast<int>(index);
+        }
+
+        bool start()
+        {
+            if (running_.load() || channels_.empty())
+            {
+                return false;
+            }
+            running_.store(true);
+            if (journal_)
+            {
+                journal_->start();
+            }
+            for (auto& channel : channels_)
+            {
+                channel->running_.store(true);
+            }
+            receiver_thread_ = std::thread(&MulticastReceiverGroup::receiver_loop, this);
+            return true;
+        }
+
+        void stop()
+        {
+            if (!running_.exchange(false))
+            {
+                return;
+            }
+            if (receiver_thread_.joinable())
+            {
+                receiver_thread_.join();
+            }
+            // closes each socket; the first stop drains the shared journal
+            for (auto& channel : channels_)
+            {
+                channel->stop();
+            }
+        }
+
+        [[nodiscard]] bool is_running() const { return running_.load(); }
+        [[nodiscard]] size_t channel_count() const { return channels_.size(); }
+
+        [[nodiscard]] MulticastReceiverBase::Stats get_stats(size_t channel) const
+        {
+            return channels_[channel]->get_stats();
+        }
+
+        [[nodiscard]] FeedState feed_state(size_t channel) const { return channels_[channel]->feed_state(); }
+
+        // on_feed_state does not say which channel changed, ask feed_state(channel)
+        Handler& handler() { return handler_; }
+
+    private:
+        using Channel = BasicMulticastReceiver<Handler*>;
+
+        // how long epoll_wait sleeps with every channel LIVE before checking for stop()
+        static constexpr std::chrono::milliseconds IDLE_WAIT{100};
+
+        void receiver_loop()
+        {
+            if (config_.receiver_cpu >= 0 && !Channel::pin_current_thread(config_.receiver_cpu)
+                && journal_)
+            {
+                journal_->record_text("Could not pin the receiver thread to CPU " +
+                    std::to_string(config_.receiver_cpu));
+            }
+            for (auto& channel : channels_)
+            {
+                channel->begin_receiving();
+            }
+
+            auto next_stats = std::chrono::steady_clock::now() + config_.stats_interval;
+            while (running_.load(std::memory_order_relaxed))
+            {
+                bool recovering = false;
+                for (const auto& channel : channels_)
+                {
+                    recovering |= channel->feed_state() != FeedState::LIVE;
+                }
+
+                if (config_.busy_poll)
+                {
+                    bool received = false;
+                    for (auto& channel : channels_)
+                    {
+                        received |= channel->poll_once() > 0;
+                    }
+                    if (!received)
+                    {
+                        cpu_relax();
+                    }
+                }
+                else
+                {
+                    // recovering channels are serviced on every pass, so wake up often enough for them
+                    const auto timeout = recovering ? Channel::RECOVERY_POLL_INTERVAL : IDLE_WAIT;
+                    for (const uint32_t index : ready_.wait(timeout))
+                    {
+                        if (channels_[index]->feed_state() == FeedState::LIVE)
+                        {
+                            channels_[index]->poll_once();
+                        }
+                    }
+                    for (auto& channel : channels_)
+                    {
+                        if (channel->feed_state() != FeedState::LIVE)
+                        {
+                            channel->poll_once();
+                        }
+                    }
+                }
+
+                if (journal_ && std::chrono::steady_clock::now() >= next_stats)
+                {
+                    next_stats += config_.stats_interval;
+                    for (auto& channel : channels_)
+                    {
+                        channel->print_stats();
+                    }
+                }
+            }
+        }
+
+        ReceiverConfig config_;
+        Handler handler_;
+        std::vector<std::unique_ptr<Channel>> channels_;
+        std::shared_ptr<MessageJournal> journal_;
+        ReadySet ready_;
+        std::atomic<bool> running_;
+        std::thread receiver_thread_;
+    };
+} // namespace mdfeed
@@ -1,6 +1,8 @@
 #pragma once
+#include "utils/WaitStrategy.h"
 #include <string>
 #include <chrono>
+#include <vector>
 
 namespace mdfeed
 {
@@ -10,10 +12,54 @@ namespace mdfeed
         uint16_t multicast_port = 9999;
         std::string interface_ip = "127.0.0.1";
         size_t receive_buffer_size = 1024 * 1024;
+        // datagrams taken from the kernel per receive call
+        size_t receive_batch_size = 32;
+        // non-blocking socket polled in a spin loop instead of sleeping in the kernel
+        bool busy_poll = false;
+        // CPU the receiver thread is pinned to, -1 leaves it to the scheduler
+        int receiver_cpu = -1;
+        // SO_TIMESTAMPNS arrival times, for the publish->wire and wire->user latencies in Stats
+        bool kernel_timestamps = true;
         bool enable_logging = true;
         bool log_to_console = true;
         std::string log_file_path;
+        // bytes of raw messages and notes the journal can hold before it drops entries
+        size_t journal_buffer_bytes = 4 * 1024 * 1024;
+        // how long the journal writer sleeps when it finds nothing to write
+        std::chrono::milliseconds journal_flush_interval{10};
         bool validate_sequence_numbers = true;
+        // instrument ids to receive, empty for all. Compiled into a socket filter
+        // so the kernel drops plain packets that carry none of them; other
+        // instruments' messages in a kept packet, and compact packets, are
+        // dropped after parsing. Filtered packets leave holes in the sequence
+        // numbers, so a non-empty list turns sequence validation and gap recovery off.
+        std::vector<uint32_t> instruments;
+        // fill sequence gaps from the publisher's RetransmitServer; a zero port disables it
+        std::string retransmit_ip = "127.0.0.1";
+        uint16_t retransmit_port = 9997;
+        // a gap fill request fails once the server has sent nothing for this long; the
+        // receiver keeps reading multicast while it waits, and retries the rest of the gap
+        std::chrono::milliseconds retransmit_timeout{100};
+        // snapshot group read only while a gap is being recovered, the one of the channel
+        // joined (see PublisherConfig::for_channel); a zero port disables it
+        std::string snapshot_ip = "239.1.1.2";
+        uint16_t snapshot_port = 9998;
+        // allocated up front for the messages held back during recovery; when it
+        // fills, recovery restarts from the next snapshot cycle
+        size_t recovery_queue_bytes = 4 * 1024 * 1024;
+        // how long a gap may stay unfilled before the feed is marked STALE
+        std::chrono::milliseconds recovery_timeout{5000};
         std::chrono::milliseconds stats_interval{5000};
+
+        // ShardedDispatcher: messages go to worker instrument_id % dispatch_shards,
+        // each fed through its own ring of dispatch_ring_bytes
+        size_t dispatch_shards = 2;
+        size_t dispatch_ring_bytes = 1024 * 1024;
+        // how an idle worker waits on its ring, see WaitStrategy
+        WaitStrategy dispatch_wait_strategy = WaitStrategy::SPIN_PARK;
+        std::chrono::microseconds dispatch_spin_duration{100};
+        std::chrono::microseconds dispatch_park_timeout{1000};
+        // CPU per worker, workers without one are unpinned
+        std::vector<int> dispatch_cpus;
     };
 }
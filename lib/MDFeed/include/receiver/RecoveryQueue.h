@@ -0,0 +1,61 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include <cstring>
+#include <vector>
+
+namespace mdfeed
+{
+    // Messages held back while a sequence gap is recovered, stored back to
+    // back in one buffer allocated up front. Each message is framed by its
+    // header's message_length, so push takes only messages that passed the
+    // receiver's length check.
+    class RecoveryQueue
+    {
+    public:
+        explicit RecoveryQueue(size_t capacity_bytes = 0)
+            : buffer_(capacity_bytes)
+        {
+        }
+
+        // false, and nothing stored, when the message does not fit
+        bool push(const void* message, size_t length)
+        {
+            if (length > buffer_.size() - used_)
+            {
+                return false;
+            }
+            std::memcpy(buffer_.data() + used_, message, length);
+            used_ += length;
+            count_++;
+            return true;
+        }
+
+        // fn(const MessageHeader&, const void* message, size_t length) in arrival order
+        template <typename Fn>
+        void for_each(Fn&& fn) const
+        {
+            for (size_t offset = 0; offset < used_;)
+            {
+                const auto* header = reinterpret_cast<const MessageHeader*>(buffer_.data() + offset);
+                fn(*header, header, static_cast<size_t>(header->message_length));
+                offset += header->message_length;
+            }
+        }
+
+        void clear()
+        {
+            used_ = 0;
+            count_ = 0;
+        }
+
+        [[nodiscard]] bool empty() const { return count_ == 0; }
+        [[nodiscard]] size_t size() const { return count_; }
+        [[nodiscard]] size_t capacity_bytes() const { return buffer_.size(); }
+
+    private:
+        std::vector<char> buffer_;
+        size_t used_ = 0;
+        size_t count_ = 0;
+    };
+}
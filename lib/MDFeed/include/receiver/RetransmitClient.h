@@ -0,0 +1,92 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mdfeed
+{
+    using PacketHandler = std::function<void(const void* packet, size_t length)>;
+
+    // Non-blocking client for RetransmitServer. A request is started, then
+    // advanced by poll from the receiver thread between multicast reads, so
+    // waiting for the server never stops the feed being read. Keeps one
+    // connection open and reconnects on the next request after a failure, at
+    // most once per reconnect_interval so an absent server costs little.
+    class RetransmitClient
+    {
+    public:
+        enum class Status
+        {
+            PENDING,
+            DONE,
+            // the server could not be reached, the reply was cut short or made no progress for timeout
+            FAILED
+        };
+
+        RetransmitClient(std::string ip, uint16_t port, std::chrono::milliseconds timeout);
+        ~RetransmitClient();
+
+        RetransmitClient(const RetransmitClient&) = delete;
+        RetransmitClient& operator=(const RetransmitClient&) = delete;
+
+        // Starts a request for [first, last]; false if one is already in flight
+        // or no connection can be attempted yet.
+        bool start(uint64_t first, uint64_t last);
+        // Reads and sends whatever the socket allows without blocking, calling
+        // handler for every packet of the reply as it completes.
+        Status poll(const PacketHandler& handler);
+        [[nodiscard]] bool busy() const { return state_ != State::IDLE; }
+        // drops the request in flight with its connection; the next request may reconnect at once
+        void cancel();
+
+        // the socket and the poll(2) events the request in flight is waiting for, -1 and 0 when idle
+        [[nodiscard]] int fd() const { return busy() ? socket_fd_ : -1; }
+        [[nodiscard]] short events() const;
+
+        // Blocking form: starts a request and polls it to the end. Returns false
+        // if the server could not be reached or the reply was cut short.
+        bool request(uint64_t first, uint64_t last, const PacketHandler& handler,
+                     RetransmitResponse* response = nullptr);
+        void close();
+
+        static constexpr std::chrono::seconds reconnect_interval{1};
+
+    private:
+        enum class State
+        {
+            IDLE,
+            CONNECTING,
+            SENDING,
+            // the RetransmitResponse, then packet_count framed packets
+            REPLY,
+            PACKETS
+        };
+
+        bool connect();
+        // bytes the current read needs in all, 0 when a packet header is out of step with the stream
+        [[nodiscard]] size_t expected_bytes() const;
+        Status fail();
+        Status wait(std::chrono::steady_clock::time_point now);
+
+        std::string ip_;
+        uint16_t port_;
+        std::chrono::milliseconds timeout_;
+        int socket_fd_;
+        bool connected_ = false;
+        std::chrono::steady_clock::time_point next_connect_;
+
+        State state_ = State::IDLE;
+        RetransmitRequest request_{};
+        size_t sent_ = 0;
+        RetransmitResponse response_{};
+        uint32_t packets_left_ = 0;
+        // of the response, or of the packet being read into packet_
+        size_t received_ = 0;
+        // pushed back by every byte sent or received
+        std::chrono::steady_clock::time_point deadline_;
+        std::vector<char> packet_;
+    };
+}
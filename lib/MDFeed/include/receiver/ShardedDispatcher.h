@@ -0,0 +1,220 @@
+#pragma once
+
+#include "MessageDispatch.h"
+#include "MulticastReceiver.h"
+#include "utils/RingBuffer.h"
+#include "utils/WaitStrategy.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace mdfeed {
+    // Optional stage between a receiver and its handlers, so one slow
+    // instrument cannot hold up the socket. Use a pointer to it as the
+    // receiver's Handler, e.g. BasicMulticastReceiver<ShardedDispatcher<BookBuilder>*>:
+    // the receiver thread only reads each message's header and copies the
+    // message onto the ring of shard instrument_id % dispatch_shards, and a
+    // worker thread per shard runs the typed callbacks of its own Handler.
+    // Each instrument's messages therefore arrive in feed order on a single
+    // thread. Feed state changes are queued to every shard in line with the
+    // messages around them.
+    template <typename Handler>
+    class ShardedDispatcher {
+    public:
+        // every shard's handler starts as a copy of prototype
+        explicit ShardedDispatcher(const ReceiverConfig& config, const Handler& prototype = Handler{})
+            : config_(config)
+              , running_(false)
+        {
+            const size_t count = std::max<size_t>(config_.dispatch_shards, 1);
+            shards_.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                shards_.push_back(std::make_unique<Shard>(config_.dispatch_ring_bytes, prototype));
+            }
+        }
+
+        ~ShardedDispatcher()
+        {
+            stop();
+        }
+
+        ShardedDispatcher(const ShardedDispatcher&) = delete;
+        ShardedDispatcher& operator=(const ShardedDispatcher&) = delete;
+
+        bool start()
+        {
+            if (running_.exchange(true))
+            {
+                return false;
+            }
+            for (size_t i = 0; i < shards_.size(); ++i)
+            {
+                shards_[i]->worker = std::thread(&ShardedDispatcher::worker_loop, this, i);
+            }
+            return true;
+        }
+
+        // Stop the receiver first: the workers drain what is already queued
+        // before they exit, and anything pushed afterwards is dropped.
+        void stop()
+        {
+            if (!running_.exchange(false))
+            {
+                return;
+            }
+            for (auto& shard : shards_)
+            {
+                if (shard->worker.joinable())
+                {
+                    shard->worker.join();
+                }
+            }
+        }
+
+        [[nodiscard]] bool is_running() const { return running_.load(); }
+        [[nodiscard]] size_t shard_count() const { return shards_.size(); }
+        [[nodiscard]] size_t shard_of(uint32_t instrument_id) const { return instrument_id % shards_.size(); }
+
+        // owned by the shard's worker, only touch it once the dispatcher has stopped
+        Handler& handler(size_t shard) { return shards_[shard]->handler; }
+
+        // receiver thread: queues the message for its shard, waiting while that ring is full
+        void on_message(const MessageHeader& header, const void* data, size_t length)
+        {
+            Shard& shard = *shards_[shard_of(header.instrument_id)];
+            if (push(shard, data, length))
+            {
+                shard.messages_dispatched++;
+            }
+        }
+
+        // receiver thread
+        void on_feed_state(FeedState state)
+        {
+            for (auto& shard : shards_)
+            {
+                push(*shard, &state, sizeof(state));
+            }
+        }
+
+        struct Stats {
+            uint64_t messages_dispatched = 0;
+            // pushes that found the ring full and had to wait for the worker
+            uint64_t ring_full_waits = 0;
+            // pushed after stop(), or too long for the ring
+            uint64_t messages_dropped = 0;
+            uint64_t messages_handled = 0;
+            // empty polls that yielded or parked rather than spun
+            uint64_t idle_parks = 0;
+        };
+
+        // exact once the receiver and dispatcher have stopped
+        [[nodiscard]] Stats get_stats(size_t shard) const
+        {
+            const Shard& s = *shards_[shard];
+            return {s.messages_dispatched, s.ring_full_waits, s.messages_dropped, s.messages_handled, s.idle_parks};
+        }
+
+    private:
+        struct Shard {
+            Shard(size_t ring_bytes, const Handler& prototype)
+                : ring(ring_bytes)
+                  , handler(prototype)
+            {
+            }
+
+            MDRingBuffer ring;
+            Handler handler;
+            std::thread worker;
+
+            // receiver thread
+            alignas(64) uint64_t messages_dispatched = 0;
+            uint64_t ring_full_waits = 0;
+            uint64_t messages_dropped = 0;
+
+            // worker thread
+            alignas(64) uint64_t messages_handled = 0;
+            uint64_t idle_parks = 0;
+        };
+
+        // Records shorter than a MessageHeader are feed state changes, so the
+        // worker sees them in order with the messages.
+        bool push(Shard& shard, const void* data, size_t length)
+        {
+            void* slot = shard.ring.claim(length);
+            if (!slot)
+            {
+                shard.ring_full_waits++;
+                while (!slot && running_.load(std::memory_order_acquire)
+                    && length <= shard.ring.capacity() / 2)
+                {
+                    cpu_relax();
+                    slot = shard.ring.claim(length);
+                }
+                if (!slot)
+                {
+                    shard.messages_dropped++;
+                    return false;
+                }
+            }
+            std::memcpy(slot, data, length);
+            shard.ring.commit(length);
+            return true;
+        }
+
+        void worker_loop(size_t index)
+        {
+            Shard& shard = *shards_[index];
+            if (index < config_.dispatch_cpus.size() && config_.dispatch_cpus[index] >= 0)
+            {
+                MulticastReceiverBase::pin_current_thread(config_.dispatch_cpus[index]);
+            }
+            IdleWaiter waiter(config_.dispatch_wait_strategy, config_.dispatch_spin_duration,
+                              config_.dispatch_park_timeout, &shard.ring);
+            while (true)
+            {
+                const auto record = shard.ring.peek();
+                if (!record)
+                {
+                    // the receiver has stopped pushing before running_ is cleared, so
+                    // one more empty peek after seeing it means the ring is drained
+                    if (!running_.load(std::memory_order_acquire))
+                    {
+                        if (!shard.ring.peek())
+                        {
+                            return;
+                        }
+                        continue;
+                    }
+                    if (waiter.idle())
+                    {
+                        shard.idle_parks++;
+                    }
+                    continue;
+                }
+                waiter.reset();
+                if (record.length < sizeof(MessageHeader))
+                {
+                    FeedState state;
+                    std::memcpy(&state, record.data, sizeof(state));
+                    dispatch_feed_state(shard.handler, state);
+                }
+                else
+                {
+                    dispatch_message(shard.handler, *static_cast<const MessageHeader*>(record.data), record.data,
+                                     record.length);
+                    shard.messages_handled++;
+                }
+                shard.ring.release();
+            }
+        }
+
+        ReceiverConfig config_;
+        std::vector<std::unique_ptr<Shard>> shards_;
+        std::atomic<bool> running_;
+    };
+} // namespace mdfeed
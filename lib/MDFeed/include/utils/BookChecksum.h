@@ -0,0 +1,47 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include <cstdint>
+
+namespace mdfeed
+{
+    // Order-independent checksum over the (side, price, quantity) of every
+    // non-empty price level. Each level is mixed on its own and the results
+    // are summed, so a level change is one subtract and one add, and a replica
+    // that applies the same level states in any order reaches the same value.
+    class BookChecksum
+    {
+    public:
+        static uint32_t level_hash(Side side, uint64_t price, uint64_t quantity)
+        {
+            // splitmix64 finaliser over the packed level, folded to 32 bits
+            uint64_t h = price * 0x9E3779B97F4A7C15ULL
+                ^ (quantity + (static_cast<uint64_t>(side) << 56));
+            h ^= h >> 30;
+            h *= 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 27;
+            h *= 0x94D049BB133111EBULL;
+            h ^= h >> 31;
+            return static_cast<uint32_t>(h ^ (h >> 32));
+        }
+
+        void update(Side side, uint64_t price, uint64_t old_quantity, uint64_t new_quantity)
+        {
+            if (old_quantity > 0)
+            {
+                value_ -= level_hash(side, price, old_quantity);
+            }
+            if (new_quantity > 0)
+            {
+                value_ += level_hash(side, price, new_quantity);
+            }
+        }
+
+        void reset() { value_ = 0; }
+
+        [[nodiscard]] uint32_t value() const { return value_; }
+
+    private:
+        uint32_t value_{0};
+    };
+}
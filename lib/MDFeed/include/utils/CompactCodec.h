@@ -0,0 +1,382 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace mdfeed
+{
+#pragma pack(push, 1)
+
+    // Follows the PacketHeader of a COMPACT packet. Message timestamps are
+    // deltas from base_timestamp_ns and prices are carried in price_tick units.
+    struct CompactPacketBase
+    {
+        uint64_t base_timestamp_ns;
+        uint32_t price_tick;
+    };
+
+#pragma pack(pop)
+
+    // Compact message layout:
+    //   type        1 byte, RAW_BODY set when the body is copied verbatim
+    //   sequence    zigzag varint delta from the previous message (the first from first_sequence_number)
+    //   timestamp   zigzag varint delta from the previous message (the first from base_timestamp_ns)
+    //   instrument  zigzag varint delta from the previous message (the first from 0)
+    //   body        per type below, or varint length + the bytes after the MessageHeader
+    //
+    //   PRICE_LEVEL_UPDATE  side << 4 | action, price ticks delta, quantity varint
+    //   PRICE_LEVEL_DELETE  side, price ticks delta
+    //   TRADE               trade id delta, price ticks delta, quantity varint, side
+    //   HEARTBEAT           checksum, 4 bytes
+    //   BOOK_CLEAR          reason_code varint
+    //
+    // Price deltas are zigzag varints from the previous price in the packet.
+    namespace compact
+    {
+        constexpr uint8_t RAW_BODY = 0x80;
+        // worst-case growth of a message over its plain size
+        constexpr size_t MAX_OVERHEAD = 32;
+
+        inline uint8_t* put_varint(uint8_t* out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                *out++ = static_cast<uint8_t>(value) | 0x80;
+                value >>= 7;
+            }
+            *out++ = static_cast<uint8_t>(value);
+            return out;
+        }
+
+        // returns nullptr when the varint runs past end or is longer than 10 bytes
+        inline const uint8_t* get_varint(const uint8_t* in, const uint8_t* end, uint64_t& value)
+        {
+            value = 0;
+            for (unsigned shift = 0; shift < 64 && in < end; shift += 7)
+            {
+                const uint8_t byte = *in++;
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return in;
+                }
+            }
+            return nullptr;
+        }
+
+        inline uint64_t zigzag(uint64_t current, uint64_t previous)
+        {
+            const auto delta = static_cast<int64_t>(current - previous);
+            return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        }
+
+        inline uint64_t unzigzag(uint64_t encoded, uint64_t previous)
+        {
+            return previous + ((encoded >> 1) ^ (~(encoded & 1) + 1));
+        }
+
+        // fields that carry over from one message to the next within a packet
+        struct DeltaState
+        {
+            uint64_t sequence_number = 0;
+            uint64_t timestamp_ns = 0;
+            uint64_t instrument_id = 0;
+            uint64_t price_ticks = 0;
+            uint64_t trade_id = 0;
+            uint64_t price_tick = 1;
+
+            void reset(uint64_t first_sequence_number, uint64_t base_timestamp_ns, uint64_t tick)
+            {
+                *this = DeltaState{};
+                sequence_number = first_sequence_number;
+                timestamp_ns = base_timestamp_ns;
+                price_tick = tick == 0 ? 1 : tick;
+            }
+        };
+
+        template <typename T>
+        constexpr bool has_compact_body = std::is_same_v<T, PriceLevelUpdateMessage>
+            || std::is_same_v<T, PriceLevelDeleteMessage>
+            || std::is_same_v<T, TradeMessage>
+            || std::is_same_v<T, HeartbeatMessage>
+            || std::is_same_v<T, BookClearMessage>;
+
+        inline uint8_t* put_header(uint8_t* out, const MessageHeader& header, uint8_t type_byte, DeltaState& state)
+        {
+            *out++ = type_byte;
+            out = put_varint(out, zigzag(header.sequence_number, state.sequence_number));
+            out = put_varint(out, zigzag(header.timestamp_ns, state.timestamp_ns));
+            out = put_varint(out, zigzag(header.instrument_id, state.instrument_id));
+            state.sequence_number = header.sequence_number;
+            state.timestamp_ns = header.timestamp_ns;
+            state.instrument_id = header.instrument_id;
+            return out;
+        }
+
+        inline uint8_t* put_price(uint8_t* out, uint64_t price, DeltaState& state)
+        {
+            const uint64_t ticks = price / state.price_tick;
+            out = put_varint(out, zigzag(ticks, state.price_ticks));
+            state.price_ticks = ticks;
+            return out;
+        }
+
+        inline uint8_t* put_raw(uint8_t* out, const void* message, size_t length, DeltaState& state)
+        {
+            const auto* header = static_cast<const MessageHeader*>(message);
+            out = put_header(out, *header, static_cast<uint8_t>(header->message_type) | RAW_BODY, state);
+            const size_t body = length - sizeof(MessageHeader);
+            out = put_varint(out, body);
+            std::memcpy(out, static_cast<const char*>(message) + sizeof(MessageHeader), body);
+            return out + body;
+        }
+
+        // encodes one message of known type, returns the end of its encoding
+        template <typename T>
+        uint8_t* encode(uint8_t* out, const T& msg, DeltaState& state)
+        {
+            if constexpr (!has_compact_body<T>)
+            {
+                return put_raw(out, &msg, sizeof(T), state);
+            }
+            else
+            {
+                if constexpr (requires { msg.price; })
+                {
+                    // a price off the tick grid cannot be carried in ticks
+                    if (msg.price % state.price_tick != 0)
+                    {
+                        return put_raw(out, &msg, sizeof(T), state);
+                    }
+                }
+                out = put_header(out, msg.header, static_cast<uint8_t>(msg.header.message_type), state);
+                if constexpr (std::is_same_v<T, PriceLevelUpdateMessage>)
+                {
+                    *out++ = static_cast<uint8_t>(static_cast<uint8_t>(msg.side) << 4 | static_cast<uint8_t>(msg.action));
+                    out = put_price(out, msg.price, state);
+                    out = put_varint(out, msg.quantity);
+                }
+                else if constexpr (std::is_same_v<T, PriceLevelDeleteMessage>)
+                {
+                    *out++ = static_cast<uint8_t>(msg.side);
+                    out = put_price(out, msg.price, state);
+                }
+                else if constexpr (std::is_same_v<T, TradeMessage>)
+                {
+                    out = put_varint(out, zigzag(msg.trade_id, state.trade_id));
+                    state.trade_id = msg.trade_id;
+                    out = put_price(out, msg.price, state);
+                    out = put_varint(out, msg.quantity);
+                    *out++ = static_cast<uint8_t>(msg.aggressor_side);
+                }
+                else if constexpr (std::is_same_v<T, HeartbeatMessage>)
+                {
+                    std::memcpy(out, &msg.checksum, sizeof(msg.checksum));
+                    out += sizeof(msg.checksum);
+                }
+                else if constexpr (std::is_same_v<T, BookClearMessage>)
+                {
+                    out = put_varint(out, msg.reason_code);
+                }
+                return out;
+            }
+        }
+
+        // decodes the body of a message of known type into msg, whose header is already set
+        template <typename T>
+        const uint8_t* decode_body(const uint8_t* in, const uint8_t* end, T& msg, DeltaState& state)
+        {
+            uint64_t value = 0;
+            auto get_price = [&](uint64_t& price) -> bool
+            {
+                in = get_varint(in, end, value);
+                if (!in)
+                {
+                    return false;
+                }
+                state.price_ticks = unzigzag(value, state.price_ticks);
+                price = state.price_ticks * state.price_tick;
+                return true;
+            };
+
+            if constexpr (std::is_same_v<T, PriceLevelUpdateMessage>)
+            {
+                if (in >= end)
+                {
+                    return nullptr;
+                }
+                msg.side = static_cast<Side>(*in >> 4);
+                msg.action = static_cast<UpdateAction>(*in++ & 0x0F);
+                if (!get_price(msg.price) || !(in = get_varint(in, end, msg.quantity)))
+                {
+                    return nullptr;
+                }
+            }
+            else if constexpr (std::is_same_v<T, PriceLevelDeleteMessage>)
+            {
+                if (in >= end)
+                {
+                    return nullptr;
+                }
+                msg.side = static_cast<Side>(*in++);
+                if (!get_price(msg.price))
+                {
+                    return nullptr;
+                }
+            }
+            else if constexpr (std::is_same_v<T, TradeMessage>)
+            {
+                if (!(in = get_varint(in, end, value)))
+                {
+                    return nullptr;
+                }
+                state.trade_id = msg.trade_id = unzigzag(value, state.trade_id);
+                if (!get_price(msg.price) || !(in = get_varint(in, end, msg.quantity)) || in >= end)
+                {
+                    return nullptr;
+                }
+                msg.aggressor_side = static_cast<Side>(*in++);
+            }
+            else if constexpr (std::is_same_v<T, HeartbeatMessage>)
+            {
+                if (end - in < static_cast<ptrdiff_t>(sizeof(msg.checksum)))
+                {
+                    return nullptr;
+                }
+                std::memcpy(&msg.checksum, in, sizeof(msg.checksum));
+                in += sizeof(msg.checksum);
+            }
+            else if constexpr (std::is_same_v<T, BookClearMessage>)
+            {
+                if (!(in = get_varint(in, end, value)))
+                {
+                    return nullptr;
+                }
+                msg.reason_code = static_cast<uint32_t>(value);
+            }
+            return in;
+        }
+
+        // encodes a plain message taken from the ring, dispatching on its type
+        inline uint8_t* encode_message(uint8_t* out, const void* message, size_t length, DeltaState& state)
+        {
+            const auto* header = static_cast<const MessageHeader*>(message);
+            switch (static_cast<MessageType>(header->message_type))
+            {
+            case MessageType::PRICE_LEVEL_UPDATE:
+                return encode(out, *static_cast<const PriceLevelUpdateMessage*>(message), state);
+            case MessageType::PRICE_LEVEL_DELETE:
+                return encode(out, *static_cast<const PriceLevelDeleteMessage*>(message), state);
+            case MessageType::TRADE:
+                return encode(out, *static_cast<const TradeMessage*>(message), state);
+            case MessageType::HEARTBEAT:
+                return encode(out, *static_cast<const HeartbeatMessage*>(message), state);
+            case MessageType::BOOK_CLEAR:
+                return encode(out, *static_cast<const BookClearMessage*>(message), state);
+            default:
+                return put_raw(out, message, length, state);
+            }
+        }
+
+        // Rebuilds each message of a COMPACT packet as its plain struct and calls
+        // handler(const MessageHeader&, const void* data, size_t length).
+        template <typename Handler>
+        bool for_each_message(const uint8_t* cursor, const uint8_t* end, const PacketHeader& packet_header,
+                              Handler&& handler)
+        {
+            if (static_cast<size_t>(end - cursor) < sizeof(CompactPacketBase))
+            {
+                return false;
+            }
+            CompactPacketBase base;
+            std::memcpy(&base, cursor, sizeof(base));
+            cursor += sizeof(base);
+
+            DeltaState state;
+            state.reset(packet_header.first_sequence_number, base.base_timestamp_ns, base.price_tick);
+            alignas(8) char scratch[256];
+
+            for (uint16_t i = 0; i < packet_header.message_count; ++i)
+            {
+                if (cursor >= end)
+                {
+                    return false;
+                }
+                const uint8_t type_byte = *cursor++;
+                uint64_t sequence = 0, timestamp = 0, instrument = 0;
+                if (!(cursor = get_varint(cursor, end, sequence))
+                    || !(cursor = get_varint(cursor, end, timestamp))
+                    || !(cursor = get_varint(cursor, end, instrument)))
+                {
+                    return false;
+                }
+                MessageHeader header{};
+                header.sequence_number = state.sequence_number = unzigzag(sequence, state.sequence_number);
+                header.timestamp_ns = state.timestamp_ns = unzigzag(timestamp, state.timestamp_ns);
+                state.instrument_id = unzigzag(instrument, state.instrument_id);
+                header.instrument_id = static_cast<uint32_t>(state.instrument_id);
+                header.message_type = type_byte & ~RAW_BODY;
+
+                if (type_byte & RAW_BODY)
+                {
+                    uint64_t body = 0;
+                    if (!(cursor = get_varint(cursor, end, body))
+                        || body > sizeof(scratch) - sizeof(MessageHeader)
+                        || body > static_cast<uint64_t>(end - cursor))
+                    {
+                        return false;
+                    }
+                    header.message_length = static_cast<uint32_t>(sizeof(MessageHeader) + body);
+                    std::memcpy(scratch, &header, sizeof(header));
+                    std::memcpy(scratch + sizeof(header), cursor, body);
+                    cursor += body;
+                    handler(*reinterpret_cast<const MessageHeader*>(scratch), scratch, header.message_length);
+                    continue;
+                }
+
+                auto decode = [&]<typename T>(T* msg) -> bool
+                {
+                    new(msg) T{};
+                    msg->header = header;
+                    msg->header.message_length = sizeof(T);
+                    cursor = decode_body(cursor, end, *msg, state);
+                    if (!cursor)
+                    {
+                        return false;
+                    }
+                    handler(msg->header, msg, sizeof(T));
+                    return true;
+                };
+                bool ok;
+                switch (static_cast<MessageType>(header.message_type))
+                {
+                case MessageType::PRICE_LEVEL_UPDATE:
+                    ok = decode(reinterpret_cast<PriceLevelUpdateMessage*>(scratch));
+                    break;
+                case MessageType::PRICE_LEVEL_DELETE:
+                    ok = decode(reinterpret_cast<PriceLevelDeleteMessage*>(scratch));
+                    break;
+                case MessageType::TRADE:
+                    ok = decode(reinterpret_cast<TradeMessage*>(scratch));
+                    break;
+                case MessageType::HEARTBEAT:
+                    ok = decode(reinterpret_cast<HeartbeatMessage*>(scratch));
+                    break;
+                case MessageType::BOOK_CLEAR:
+                    ok = decode(reinterpret_cast<BookClearMessage*>(scratch));
+                    break;
+                default:
+                    ok = false;
+                    break;
+                }
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+            return cursor == end;
+        }
+    }
+}
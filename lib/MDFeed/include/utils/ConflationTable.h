@@ -0,0 +1,203 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace mdfeed
+{
+    // Latest state of each price level that could not be written while the
+    // ring was full. Open addressing with linear probing over slots allocated
+    // up front, so conflating never allocates on the matching thread. Holds at
+    // most capacity levels; upsert refuses a new level beyond that. Erased
+    // slots stay tombstones until the table is compacted into its spare
+    // slots, which are allocated up front too.
+    class ConflationTable
+    {
+    public:
+        struct Key
+        {
+            uint32_t instrument_id;
+            Side side;
+            uint64_t price;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        struct Level
+        {
+            uint64_t quantity;
+            // whether receivers already have the level, which decides NEW vs CHANGE on drain
+            bool existed_before;
+        };
+
+        explicit ConflationTable(size_t capacity)
+            : capacity_(capacity)
+              , slots_(capacity == 0 ? 0 : std::bit_ceil(capacity * 2))
+              , spare_(slots_.size())
+        {
+        }
+
+        [[nodiscard]] bool empty() const { return size_ == 0; }
+        [[nodiscard]] size_t size() const { return size_; }
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+        // sets the quantity of a pending level, or adds it with existed_before;
+        // false when it is new and the table already holds capacity levels
+        bool upsert(const Key& key, uint64_t quantity, bool existed_before)
+        {
+            if (slots_.empty())
+            {
+                return false;
+            }
+            Slot* free = nullptr;
+            for (size_t i = hash(key);; i = (i + 1) & (slots_.size() - 1))
+            {
+                Slot& slot = slots_[i];
+                if (slot.state == State::EMPTY)
+                {
+                    free = free ? free : &slot;
+                    break;
+                }
+                if (slot.state == State::ERASED)
+                {
+                    free = free ? free : &slot;
+                }
+                else if (slot.key == key)
+                {
+                    slot.level.quantity = quantity;
+                    return true;
+                }
+            }
+            if (size_ == capacity_)
+            {
+                return false;
+            }
+            if (free->state == State::EMPTY)
+            {
+                used_++;
+            }
+            *free = Slot{key, Level{quantity, existed_before}, State::FULL};
+            size_++;
+            // keep an empty slot on every probe path
+            if (used_ > slots_.size() * 3 / 4)
+            {
+                compact();
+            }
+            return true;
+        }
+
+        // Calls bool fn(const Key&, const Level&) for each pending level and
+        // erases it, stopping at the first that returns false, which stays.
+        // Returns whether the table is now empty.
+        template <typename Fn>
+        bool drain(Fn&& fn)
+        {
+            for (Slot& slot : slots_)
+            {
+                if (size_ == 0)
+                {
+                    break;
+                }
+                if (slot.state != State::FULL)
+                {
+                    continue;
+                }
+                if (!fn(slot.key, slot.level))
+                {
+                    return false;
+                }
+                erase(slot);
+            }
+            if (used_ > 0)
+            {
+                reset();
+            }
+            return true;
+        }
+
+        template <typename Pred>
+        void erase_if(Pred&& pred)
+        {
+            for (Slot& slot : slots_)
+            {
+                if (slot.state == State::FULL && pred(slot.key))
+                {
+                    erase(slot);
+                }
+            }
+        }
+
+    private:
+        enum class State : uint8_t
+        {
+            EMPTY,
+            FULL,
+            ERASED
+        };
+
+        struct Slot
+        {
+            Key key{};
+            Level level{};
+            State state = State::EMPTY;
+        };
+
+        size_t hash(const Key& key) const
+        {
+            uint64_t h = key.price * 0x9E3779B97F4A7C15ull;
+            const uint64_t book = (static_cast<uint64_t>(key.instrument_id) << 1) | static_cast<uint64_t>(key.side);
+            h ^= book * 0xC2B2AE3D27D4EB4Full;
+            return static_cast<size_t>(h ^ (h >> 29)) & (slots_.size() - 1);
+        }
+
+        void erase(Slot& slot)
+        {
+            slot.state = State::ERASED;
+            size_--;
+        }
+
+        void reset()
+        {
+            for (Slot& slot : slots_)
+            {
+                slot.state = State::EMPTY;
+            }
+            size_ = 0;
+            used_ = 0;
+        }
+
+        // rehashes the live levels into the spare slots, dropping tombstones
+        void compact()
+        {
+            for (Slot& slot : spare_)
+            {
+                slot.state = State::EMPTY;
+            }
+            slots_.swap(spare_);
+            for (const Slot& slot : spare_)
+            {
+                if (slot.state != State::FULL)
+                {
+                    continue;
+                }
+                size_t i = hash(slot.key);
+                while (slots_[i].state != State::EMPTY)
+                {
+                    i = (i + 1) & (slots_.size() - 1);
+                }
+                slots_[i] = slot;
+            }
+            used_ = size_;
+        }
+
+        size_t capacity_;
+        size_t size_ = 0;
+        // FULL and ERASED slots, which probes walk past
+        size_t used_ = 0;
+        std::vector<Slot> slots_;
+        std::vector<Slot> spare_;
+    };
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include "utils/BookChecksum.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace mdfeed
+{
+    struct SnapshotLevel
+    {
+        uint64_t price;
+        uint64_t quantity;
+    };
+
+    // Immutable levels of one book, shared by every image taken while the
+    // book does not change.
+    struct BookDepth
+    {
+        uint32_t checksum = 0;
+        std::vector<SnapshotLevel> bids; // best first
+        std::vector<SnapshotLevel> asks; // best first
+    };
+
+    // Depth image of one book, consistent with the incremental feed up to
+    // and including sequence_number.
+    struct BookImage
+    {
+        uint32_t instrument_id = 0;
+        uint64_t sequence_number = 0;
+        std::shared_ptr<const BookDepth> depth;
+    };
+
+    using BookImageSet = std::map<uint32_t, BookImage>;
+
+    // Replica of every book on the feed, rebuilt from the level messages, for
+    // code that sees only the feed and not the books themselves.
+    class FeedBooks
+    {
+    public:
+        void apply(const MessageHeader& header, const void* message)
+        {
+            switch (static_cast<MessageType>(header.message_type))
+            {
+            case MessageType::PRICE_LEVEL_UPDATE:
+                {
+                    const auto* msg = static_cast<const PriceLevelUpdateMessage*>(message);
+                    set_level(header.instrument_id, msg->side, msg->price, msg->quantity);
+                    break;
+                }
+            case MessageType::PRICE_LEVEL_DELETE:
+                {
+                    const auto* msg = static_cast<const PriceLevelDeleteMessage*>(message);
+                    set_level(header.instrument_id, msg->side, msg->price, 0);
+                    break;
+                }
+            case MessageType::BOOK_CLEAR:
+                books_[header.instrument_id] = Book{};
+                dirty_.insert(header.instrument_id);
+                break;
+            default:
+                break;
+            }
+        }
+
+        // bool fn(uint32_t instrument_id, uint32_t checksum) for every instrument seen so far,
+        // in id order from next on. When fn returns false, next is left at that instrument
+        // so a later call resumes there, and the call returns true; false once all were visited.
+        template <typename Fn>
+        bool for_each_checksum(uint32_t& next, Fn&& fn) const
+        {
+            for (auto it = books_.lower_bound(next); it != books_.end(); ++it)
+            {
+                if (!fn(it->first, it->second.checksum.value()))
+                {
+                    next = it->first;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        [[nodiscard]] size_t size() const { return books_.size(); }
+
+        // Copy-on-write: books changed since the last call get fresh depth,
+        // the rest keep sharing theirs. Every image is stamped with
+        // sequence_number, an untouched book's depth is still current there,
+        // and a receiver recovering past its last change needs it all the same.
+        void refresh_images(BookImageSet& images, uint64_t sequence_number)
+        {
+            for (const uint32_t instrument_id : dirty_)
+            {
+                const Book& book = books_[instrument_id];
+                auto depth = std::make_shared<BookDepth>();
+                depth->checksum = book.checksum.value();
+                copy_levels(book.bids, depth->bids, true);
+                copy_levels(book.asks, depth->asks, false);
+                BookImage& image = images[instrument_id];
+                image.instrument_id = instrument_id;
+                image.depth = std::move(depth);
+            }
+            dirty_.clear();
+            for (auto& [instrument_id, image] : images)
+            {
+                image.sequence_number = sequence_number;
+            }
+        }
+
+    private:
+        using Levels = std::unordered_map<uint64_t, uint64_t>;
+
+        struct Book
+        {
+            Levels bids;
+            Levels asks;
+            BookChecksum checksum;
+        };
+
+        void set_level(uint32_t instrument_id, Side side, uint64_t price, uint64_t quantity)
+        {
+            Book& book = books_[instrument_id];
+            dirty_.insert(instrument_id);
+            Levels& levels = side == Side::BUY ? book.bids : book.asks;
+            auto it = levels.find(price);
+            const uint64_t old_quantity = it == levels.end() ? 0 : it->second;
+            book.checksum.update(side, price, old_quantity, quantity);
+            if (quantity == 0)
+            {
+                if (it != levels.end())
+                {
+                    levels.erase(it);
+                }
+            }
+            else if (it == levels.end())
+            {
+                levels.emplace(price, quantity);
+            }
+            else
+            {
+                it->second = quantity;
+            }
+        }
+
+        static void copy_levels(const Levels& levels, std::vector<SnapshotLevel>& out, bool descending)
+        {
+            out.reserve(levels.size());
+            for (const auto& [price, quantity] : levels)
+            {
+                out.push_back({price, quantity});
+            }
+            std::sort(out.begin(), out.end(), [descending](const SnapshotLevel& a, const SnapshotLevel& b)
+            {
+                return descending ? a.price > b.price : a.price < b.price;
+            });
+        }
+
+        std::map<uint32_t, Book> books_;
+        std::set<uint32_t> dirty_;
+    };
+}
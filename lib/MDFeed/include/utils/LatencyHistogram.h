@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace mdfeed
+{
+    struct LatencySummary
+    {
+        uint64_t count = 0;
+        uint64_t p50_ns = 0;
+        uint64_t p99_ns = 0;
+        uint64_t p999_ns = 0;
+        uint64_t max_ns = 0;
+    };
+
+    // Fixed-size log-linear histogram of nanosecond latencies. Values below
+    // 2^SUB_BITS get a bucket each; above that every power of two is split
+    // into 2^SUB_BITS equal buckets, so a reported percentile is within about
+    // 3% of the true value. Recording is a bit scan and an increment, and
+    // nothing allocates. Values past MAX_NS land in the last bucket, max_ns
+    // stays exact. One thread records; the counters are relaxed atomics so
+    // another thread can take a summary meanwhile, which may then miss the
+    // samples recorded while it ran.
+    class LatencyHistogram
+    {
+    public:
+        static constexpr unsigned SUB_BITS = 5;
+        static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BITS;
+        // about 18 minutes
+        static constexpr unsigned MAX_BITS = 40;
+        static constexpr uint64_t MAX_NS = (uint64_t{1} << MAX_BITS) - 1;
+        static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (MAX_BITS - SUB_BITS + 1);
+
+        // single writer, so plain loads and stores rather than locked increments
+        void record(uint64_t ns)
+        {
+            auto& bucket = counts_[bucket_of(std::min(ns, MAX_NS))];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (ns > max_.load(std::memory_order_relaxed))
+            {
+                max_.store(ns, std::memory_order_relaxed);
+            }
+        }
+
+        // the smallest bucket bound at or above fraction of the recorded values, e.g. 0.99
+        [[nodiscard]] uint64_t percentile(double fraction) const
+        {
+            const uint64_t count = count_.load(std::memory_order_relaxed);
+            const uint64_t max = max_.load(std::memory_order_relaxed);
+            if (count == 0)
+            {
+                return 0;
+            }
+            const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(count)
+                                                                             + 0.5));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                seen += counts_[i].load(std::memory_order_relaxed);
+                if (seen >= target)
+                {
+                    return std::min(upper_bound_of(i), max);
+                }
+            }
+            return max;
+        }
+
+        [[nodiscard]] LatencySummary summary() const
+        {
+            return {count(), percentile(0.5), percentile(0.99), percentile(0.999), max()};
+        }
+
+        [[nodiscard]] uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+        void reset()
+        {
+            for (auto& bucket : counts_)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            count_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+
+        static size_t bucket_of(uint64_t ns)
+        {
+            if (ns < SUB_BUCKETS)
+            {
+                return static_cast<size_t>(ns);
+            }
+            // ns >> shift falls in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+            const unsigned shift = static_cast<unsigned>(std::bit_width(ns)) - 1 - SUB_BITS;
+            return static_cast<size_t>(SUB_BUCKETS * (shift + 1) + ((ns >> shift) - SUB_BUCKETS));
+        }
+
+        // largest value that maps to bucket
+        static uint64_t upper_bound_of(size_t bucket)
+        {
+            if (bucket < SUB_BUCKETS)
+            {
+                return bucket;
+            }
+            const uint64_t shift = bucket / SUB_BUCKETS - 1;
+            const uint64_t sub = bucket % SUB_BUCKETS + SUB_BUCKETS;
+            return ((sub + 1) << shift) - 1;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+}
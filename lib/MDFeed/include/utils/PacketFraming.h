@@ -0,0 +1,144 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include "utils/CompactCodec.h"
+#include <cstring>
+
+namespace mdfeed
+{
+    // Largest UDP payload that fits a 1500 byte Ethernet MTU without IP fragmentation
+    constexpr size_t MAX_PACKET_SIZE = 1472;
+
+    class PacketBuilder
+    {
+    public:
+        explicit PacketBuilder(size_t byte_budget = MAX_PACKET_SIZE, PacketFormat format = PacketFormat::PLAIN,
+                               uint32_t price_tick = 1)
+            : byte_budget_(byte_budget < MAX_PACKET_SIZE ? byte_budget : MAX_PACKET_SIZE)
+              , format_(format)
+              , price_tick_(price_tick == 0 ? 1 : price_tick)
+        {
+            reset();
+        }
+
+        [[nodiscard]] bool fits(size_t length) const
+        {
+            const size_t worst_case = format_ == PacketFormat::COMPACT ? length + compact::MAX_OVERHEAD : length;
+            return length_ + worst_case <= byte_budget_;
+        }
+
+        // Returns false, and appends nothing, if the message does not fit. Callers
+        // check fits() first to close a full packet; a message that does not fit
+        // an empty one is larger than the byte budget and can never be sent.
+        bool append(const void* message, size_t length)
+        {
+            if (!fits(length))
+            {
+                return false;
+            }
+            const auto* header = static_cast<const MessageHeader*>(message);
+            if (count_ == 0)
+            {
+                header_()->first_sequence_number = header->sequence_number;
+                if (format_ == PacketFormat::COMPACT)
+                {
+                    const CompactPacketBase base{header->timestamp_ns, price_tick_};
+                    std::memcpy(buffer_ + sizeof(PacketHeader), &base, sizeof(base));
+                    deltas_.reset(header->sequence_number, header->timestamp_ns, price_tick_);
+                }
+            }
+            header_()->last_sequence_number = header->sequence_number;
+            if (format_ == PacketFormat::COMPACT)
+            {
+                auto* out = reinterpret_cast<uint8_t*>(buffer_ + length_);
+                length_ += compact::encode_message(out, message, length, deltas_) - out;
+            }
+            else
+            {
+                std::memcpy(buffer_ + length_, message, length);
+                length_ += length;
+            }
+            count_++;
+            return true;
+        }
+
+        // stamps count and length into the header and returns the datagram size
+        size_t finish()
+        {
+            header_()->message_count = count_;
+            header_()->packet_length = static_cast<uint16_t>(length_);
+            return length_;
+        }
+
+        void reset()
+        {
+            std::memset(buffer_, 0, sizeof(PacketHeader));
+            header_()->format = format_;
+            length_ = sizeof(PacketHeader) + (format_ == PacketFormat::COMPACT ? sizeof(CompactPacketBase) : 0);
+            count_ = 0;
+        }
+
+        [[nodiscard]] const char* data() const { return buffer_; }
+        [[nodiscard]] size_t length() const { return length_; }
+        [[nodiscard]] uint16_t message_count() const { return count_; }
+        [[nodiscard]] bool empty() const { return count_ == 0; }
+
+    private:
+        PacketHeader* header_() { return reinterpret_cast<PacketHeader*>(buffer_); }
+
+        alignas(8) char buffer_[MAX_PACKET_SIZE];
+        size_t byte_budget_;
+        PacketFormat format_;
+        uint32_t price_tick_;
+        compact::DeltaState deltas_;
+        size_t length_;
+        uint16_t count_;
+    };
+
+    // Calls handler(const MessageHeader&, const void* data, size_t length) for each
+    // message in the packet. Returns false if the packet or a message is malformed;
+    // messages before the malformed one have already been delivered.
+    template <typename Handler>
+    bool for_each_message(const void* packet, size_t length, Handler&& handler)
+    {
+        if (length < sizeof(PacketHeader))
+        {
+            return false;
+        }
+        const auto* packet_header = static_cast<const PacketHeader*>(packet);
+        if (packet_header->packet_length != length)
+        {
+            return false;
+        }
+
+        if (packet_header->format == PacketFormat::COMPACT)
+        {
+            const auto* bytes = static_cast<const uint8_t*>(packet);
+            return compact::for_each_message(bytes + sizeof(PacketHeader), bytes + length, *packet_header,
+                                             std::forward<Handler>(handler));
+        }
+        if (packet_header->format != PacketFormat::PLAIN)
+        {
+            return false;
+        }
+
+        const auto* cursor = static_cast<const char*>(packet) + sizeof(PacketHeader);
+        const auto* end = static_cast<const char*>(packet) + length;
+        for (uint16_t i = 0; i < packet_header->message_count; ++i)
+        {
+            if (static_cast<size_t>(end - cursor) < sizeof(MessageHeader))
+            {
+                return false;
+            }
+            const auto* header = reinterpret_cast<const MessageHeader*>(cursor);
+            if (header->message_length < sizeof(MessageHeader)
+                || header->message_length > static_cast<size_t>(end - cursor))
+            {
+                return false;
+            }
+            handler(*header, cursor, header->message_length);
+            cursor += header->message_length;
+        }
+        return cursor == end;
+    }
+}
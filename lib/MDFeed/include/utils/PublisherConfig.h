@@ -1,6 +1,9 @@
 #pragma once
+#include "utils/WaitStrategy.h"
 #include <string>
 #include <chrono>
+#include <unordered_map>
+#include <vector>
 
 namespace mdfeed
 {
@@ -9,10 +12,121 @@ namespace mdfeed
         std::string multicast_ip = "239.1.1.1";
         uint16_t multicast_port = 9999;
         std::string interface_ip = "127.0.0.1";
+        // idle time after which the publisher thread sends heartbeats, zero disables them
         std::chrono::milliseconds heartbeat_interval{1000};
-        bool use_busy_wait = false;
+        // one heartbeat per instrument carrying a checksum rebuilt from the published levels
+        bool heartbeat_checksums = true;
+        // how often the publisher thread sends STATISTICS for every instrument that has
+        // traded, rebuilt from the trades it sent; zero disables them
+        std::chrono::milliseconds statistics_interval{1000};
+        // the rolling window is TradeStatistics::WINDOW_BUCKETS buckets of this width
+        std::chrono::milliseconds statistics_bucket_width{1000};
+        // separate group so incremental-only receivers never see snapshot traffic; every
+        // channel has its own, derived like its multicast group. A zero port disables snapshots
+        std::string snapshot_ip = "239.1.1.2";
+        uint16_t snapshot_port = 9998;
+        // how often each book image is refreshed and re-sent on the snapshot group
+        std::chrono::milliseconds snapshot_interval{1000};
+        // incremental packets kept per channel for TCP gap fill, served on
+        // interface_ip at retransmit_port + channel; a zero port disables the service
+        size_t retransmit_packets = 8192;
+        uint16_t retransmit_port = 9997;
+        // how the sender thread waits on an empty ring, see WaitStrategy
+        WaitStrategy wait_strategy = WaitStrategy::SPIN_YIELD;
         std::chrono::microseconds spin_duration{100};
-        size_t ring_buffer_size = 65536;
+        // longest SPIN_PARK sleep, bounds how late an idle heartbeat can be
+        std::chrono::microseconds park_timeout{1000};
+        // bytes; most messages take a 64 byte record, so this holds roughly 64K of them
+        size_t ring_buffer_bytes = 4 * 1024 * 1024;
+        // when the ring is full, keep the latest state per price level and write it once
+        // the consumer catches up, instead of dropping level updates
+        bool conflate_on_backpressure = false;
+        // distinct levels the conflation table holds, allocated up front; an update to a new
+        // level beyond that is dropped, consuming its sequence number like any other drop
+        size_t conflation_capacity = 4096;
+        // minimum time between attempts to drain the conflation table from the publish path
+        std::chrono::microseconds conflation_interval{1000};
+        // byte budget for packing messages into one datagram, capped at MAX_PACKET_SIZE
+        size_t max_packet_size = 1472;
+        // delta/varint encode incremental packets (PacketFormat::COMPACT), prices in price_tick units
+        bool compact_encoding = false;
+        uint32_t price_tick = 1;
+        // datagrams handed to the kernel per send call
+        size_t max_burst_datagrams = 16;
+        // CPU the sender thread is pinned to, -1 leaves it to the scheduler
+        int sender_cpu = -1;
+        // SCHED_FIFO/SCHED_RR need CAP_SYS_NICE; priority is ignored for OTHER
+        SchedulerPolicy sender_scheduler = SchedulerPolicy::OTHER;
+        int sender_priority = 0;
+
+        // instruments are spread over channel_count channels, each with its own ring,
+        // sequence numbers, sender thread and multicast group
+        size_t channel_count = 1;
+        // explicit instrument -> channel assignments, others go to instrument_id % channel_count;
+        // MarketDataChannels rejects an assignment to a channel past channel_count
+        std::unordered_map<uint32_t, size_t> instrument_channels;
+        // group per channel; channels without one use multicast_ip with the channel
+        // index added to its third octet, so channel 0 keeps multicast_ip
+        std::vector<std::string> channel_ips;
+        // sender_cpu per channel, channels without one are unpinned
+        std::vector<int> channel_cpus;
+
+        [[nodiscard]] size_t channel_of(uint32_t instrument_id) const
+        {
+            if (const auto it = instrument_channels.find(instrument_id); it != instrument_channels.end())
+            {
+                return it->second < channel_count ? it->second : 0;
+            }
+            return channel_count == 0 ? 0 : instrument_id % channel_count;
+        }
+
+        // the settings a single channel's publisher and sender thread run with
+        [[nodiscard]] PublisherConfig for_channel(size_t channel) const
+        {
+            PublisherConfig config = *this;
+            config.channel_count = 1;
+            config.instrument_channels.clear();
+            config.channel_ips.clear();
+            config.channel_cpus.clear();
+            if (channel < channel_cpus.size())
+            {
+                config.sender_cpu = channel_cpus[channel];
+            }
+            else if (channel > 0)
+            {
+                config.sender_cpu = -1;
+            }
+            if (retransmit_port != 0)
+            {
+                config.retransmit_port = static_cast<uint16_t>(retransmit_port + channel);
+            }
+            if (channel < channel_ips.size())
+            {
+                config.multicast_ip = channel_ips[channel];
+            }
+            else if (channel > 0)
+            {
+                config.multicast_ip = offset_third_octet(multicast_ip, channel);
+            }
+            if (channel > 0)
+            {
+                config.snapshot_ip = offset_third_octet(snapshot_ip, channel);
+            }
+            return config;
+        }
+
+    private:
+        static std::string offset_third_octet(const std::string& ip, size_t offset)
+        {
+            const size_t second_dot = ip.find('.', ip.find('.') + 1);
+            const size_t third_dot = ip.find('.', second_dot + 1);
+            if (second_dot == std::string::npos || third_dot == std::string::npos)
+            {
+                return ip;
+            }
+            const auto octet = std::stoul(ip.substr(second_dot + 1, third_dot - second_dot - 1)) + offset;
+            return ip.substr(0, second_dot + 1) + std::to_string(octet % 256) + ip.substr(third_dot);
+        }
     };
 }
 
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "messages/Messages.h"
+#include "utils/PacketFraming.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+namespace mdfeed
+{
+    // The last packet_capacity incremental packets exactly as they went on the
+    // wire. The sender thread stores every packet it frames and the retransmit
+    // server reads them concurrently. Each slot is a seqlock, so the writer never
+    // waits: a reader that races the writer lapping a slot treats it as evicted.
+    class RetransmitStore
+    {
+    public:
+        struct Range
+        {
+            uint64_t first = 0;
+            uint64_t last = 0;
+
+            [[nodiscard]] bool empty() const { return first == 0 && last == 0; }
+        };
+
+        explicit RetransmitStore(size_t packet_capacity)
+            : capacity_(round_up_capacity(packet_capacity))
+              , slots_(std::make_unique<Slot[]>(capacity_))
+        {
+        }
+
+        RetransmitStore(const RetransmitStore&) = delete;
+        RetransmitStore& operator=(const RetransmitStore&) = delete;
+
+        // sender thread only; evicts the oldest packet once the store is full
+        void store(const void* packet, size_t length)
+        {
+            const auto* header = static_cast<const PacketHeader*>(packet);
+            const uint64_t index = stored_.load(std::memory_order_relaxed);
+            Slot& slot = slots_[index & (capacity_ - 1)];
+            const uint64_t version = slot.version.load(std::memory_order_relaxed);
+            slot.version.store(version + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.index.store(index, std::memory_order_relaxed);
+            slot.first_sequence_number.store(header->first_sequence_number, std::memory_order_relaxed);
+            slot.last_sequence_number.store(header->last_sequence_number, std::memory_order_relaxed);
+            slot.length.store(static_cast<uint32_t>(std::min(length, MAX_PACKET_SIZE)), std::memory_order_relaxed);
+            std::memcpy(slot.data, packet, std::min(length, MAX_PACKET_SIZE));
+            slot.version.store(version + 2, std::memory_order_release);
+            stored_.store(index + 1, std::memory_order_release);
+        }
+
+        // Calls fn(const void* packet, size_t length) for each held packet that
+        // overlaps [first, last], oldest first, and returns the sequence range
+        // held when the call started. Packets may start before first.
+        template <typename Fn>
+        Range for_each_packet(uint64_t first, uint64_t last, Fn&& fn) const
+        {
+            const uint64_t stored = stored_.load(std::memory_order_acquire);
+            uint64_t low = stored > capacity_ ? stored - capacity_ : 0;
+
+            SlotView oldest;
+            while (low < stored && !read_slot(low, oldest, nullptr))
+            {
+                ++low;
+            }
+            SlotView newest;
+            if (low == stored || !read_slot(stored - 1, newest, nullptr))
+            {
+                return {};
+            }
+            const Range held{oldest.first_sequence_number, newest.last_sequence_number};
+
+            // first packet whose last sequence number reaches first
+            uint64_t high = stored;
+            while (low < high)
+            {
+                const uint64_t mid = low + (high - low) / 2;
+                SlotView view;
+                if (!read_slot(mid, view, nullptr) || view.last_sequence_number < first)
+                {
+                    // an unreadable slot was evicted under us, as was everything before it
+                    low = mid + 1;
+                }
+                else
+                {
+                    high = mid;
+                }
+            }
+
+            alignas(8) char packet[MAX_PACKET_SIZE];
+            for (uint64_t index = low; index < stored; ++index)
+            {
+                SlotView view;
+                if (!read_slot(index, view, packet) || view.first_sequence_number > last)
+                {
+                    break;
+                }
+                fn(static_cast<const void*>(packet), view.length);
+            }
+            return held;
+        }
+
+        [[nodiscard]] size_t capacity() const { return capacity_; }
+
+    private:
+        struct alignas(64) Slot
+        {
+            // odd while the sender is rewriting the slot
+            std::atomic<uint64_t> version{0};
+            std::atomic<uint64_t> index{0};
+            std::atomic<uint64_t> first_sequence_number{0};
+            std::atomic<uint64_t> last_sequence_number{0};
+            std::atomic<uint32_t> length{0};
+            char data[MAX_PACKET_SIZE];
+        };
+
+        struct SlotView
+        {
+            uint64_t first_sequence_number = 0;
+            uint64_t last_sequence_number = 0;
+            size_t length = 0;
+        };
+
+        static size_t round_up_capacity(size_t capacity)
+        {
+            size_t rounded = 1;
+            while (rounded < capacity)
+            {
+                rounded <<= 1;
+            }
+            return rounded;
+        }
+
+        // copies the packet into out when it is not null; false if the slot no longer holds packet index
+        bool read_slot(uint64_t index, SlotView& view, char* out) const
+        {
+            const Slot& slot = slots_[index & (capacity_ - 1)];
+            const uint64_t version = slot.version.load(std::memory_order_acquire);
+            if (version & 1)
+            {
+                return false;
+            }
+            const uint64_t held_index = slot.index.load(std::memory_order_relaxed);
+            view.first_sequence_number = slot.first_sequence_number.load(std::memory_order_relaxed);
+            view.last_sequence_number = slot.last_sequence_number.load(std::memory_order_relaxed);
+            view.length = slot.length.load(std::memory_order_relaxed);
+            if (out)
+            {
+                std::memcpy(out, slot.data, view.length);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return slot.version.load(std::memory_order_relaxed) == version && held_index == index
+                && version != 0;
+        }
+
+        const size_t capacity_;
+        std::unique_ptr<Slot[]> slots_;
+        std::atomic<uint64_t> stored_{0};
+    };
+}
@@ -1,35 +1,190 @@
 #pragma once
 
-#include <boost/lockfree/spsc_queue.hpp>
-#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
 
 namespace mdfeed {
 
-    struct MessageBuffer {
-        static constexpr size_t MAX_MESSAGE_SIZE = 256;
-        alignas(8) char data[MAX_MESSAGE_SIZE];
-        size_t length;
+    // Single-producer single-consumer ring of variable-length records. The
+    // producer claims space, encodes a message in place and commits it; the
+    // consumer peeks the oldest record, reads it in place and releases it.
+    // Records are 8-byte aligned, prefixed by their length, and never wrap:
+    // when a record does not fit before the end of the buffer the rest of the
+    // buffer is skipped with a padding marker.
+    class ByteRing {
+    public:
+        struct Record {
+            const void* data;
+            size_t length;
+
+            explicit operator bool() const { return data != nullptr; }
+        };
+
+        explicit ByteRing(size_t capacity)
+                : capacity_(round_up_capacity(capacity)), mask_(capacity_ - 1),
+                  buffer_(std::make_unique<uint64_t[]>(capacity_ / sizeof(uint64_t))) {
+        }
+
+        ByteRing(const ByteRing&) = delete;
+        ByteRing& operator=(const ByteRing&) = delete;
+
+        // producer: returns space for up to length bytes, or nullptr if the ring is full
+        void* claim(size_t length) {
+            const size_t total = record_size(length);
+            if (total > capacity_ / 2) [[unlikely]] {
+                return nullptr;
+            }
+            const size_t offset = write_pos_ & mask_;
+            const size_t contiguous = capacity_ - offset;
+            const size_t skip = total > contiguous ? contiguous : 0;
+            if (!has_space(skip + total)) {
+                return nullptr;
+            }
+            if (skip > 0) {
+                header_at(offset) = PADDING;
+            }
+            claim_pos_ = write_pos_ + skip;
+            return bytes() + (claim_pos_ & mask_) + HEADER_SIZE;
+        }
+
+        // producer: publishes the claimed record, length may be smaller than claimed
+        void commit(size_t length) {
+            header_at(claim_pos_ & mask_) = length;
+            write_pos_ = claim_pos_ + record_size(length);
+            write_index_.store(write_pos_, std::memory_order_release);
+            if (doorbell_enabled_.load(std::memory_order_relaxed)) [[unlikely]] {
+                ring_doorbell();
+            }
+        }
+
+        // consumer: the oldest committed record, or a null record if the ring is empty
+        Record peek() {
+            while (true) {
+                if (read_pos_ == cached_write_) {
+                    cached_write_ = write_index_.load(std::memory_order_acquire);
+                    if (read_pos_ == cached_write_) {
+                        return {nullptr, 0};
+                    }
+                }
+                const size_t offset = read_pos_ & mask_;
+                const uint64_t length = header_at(offset);
+                if (length == PADDING) {
+                    read_pos_ += capacity_ - offset;
+                    continue;
+                }
+                return {bytes() + offset + HEADER_SIZE, static_cast<size_t>(length)};
+            }
+        }
+
+        // consumer: frees the record returned by the last peek
+        void release() {
+            read_pos_ += record_size(header_at(read_pos_ & mask_));
+            read_index_.store(read_pos_, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool empty() const {
+            return read_index_.load(std::memory_order_acquire) == write_index_.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] size_t capacity() const { return capacity_; }
 
-        MessageBuffer() : length(0) {}
+        // Lets the consumer sleep in wait_for_data. Until enabled, commit never
+        // pays for the fence that checking for a parked consumer needs.
+        void enable_doorbell() { doorbell_enabled_.store(true, std::memory_order_relaxed); }
+
+        // consumer: sleeps until the producer commits or the timeout passes
+        void wait_for_data(std::chrono::microseconds timeout) {
+            const uint32_t seen = doorbell_.load(std::memory_order_acquire);
+            consumer_parked_.store(true, std::memory_order_relaxed);
+            // pairs with the fence in ring_doorbell: either the producer sees us
+            // parked or we see its write index
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (write_index_.load(std::memory_order_relaxed) == read_pos_) {
+#ifdef __linux__
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count();
+                timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+                syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell_), FUTEX_WAIT_PRIVATE, seen, &ts,
+                        nullptr, 0);
+#else
+                (void) seen;
+                (void) timeout;
+                std::this_thread::yield();
+#endif
+            }
+            consumer_parked_.store(false, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr size_t HEADER_SIZE = sizeof(uint64_t);
+        static constexpr uint64_t PADDING = ~uint64_t{0};
+
+        static size_t round_up_capacity(size_t capacity) {
+            size_t rounded = 64;
+            while (rounded < capacity) {
+                rounded <<= 1;
+            }
+            return rounded;
+        }
 
-        template<typename T>
-        MessageBuffer(const T& message) : length(sizeof(T)) {
-            static_assert(sizeof(T) <= MAX_MESSAGE_SIZE, "Message too large for buffer");
-            std::memcpy(data, &message, sizeof(T));
+        static size_t record_size(size_t length) {
+            return HEADER_SIZE + ((length + 7) & ~size_t{7});
         }
 
-        template<typename T>
-        T* as() {
-            static_assert(sizeof(T) <= MAX_MESSAGE_SIZE, "Message too large for buffer");
-            return reinterpret_cast<T*>(data);
+        bool has_space(size_t needed) {
+            if (write_pos_ + needed - cached_read_ <= capacity_) {
+                return true;
+            }
+            cached_read_ = read_index_.load(std::memory_order_acquire);
+            return write_pos_ + needed - cached_read_ <= capacity_;
         }
 
-        template<typename T>
-        const T* as() const {
-            static_assert(sizeof(T) <= MAX_MESSAGE_SIZE, "Message too large for buffer");
-            return reinterpret_cast<const T*>(data);
+        void ring_doorbell() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (consumer_parked_.load(std::memory_order_relaxed)) {
+                doorbell_.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+                syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell_), FUTEX_WAKE_PRIVATE, 1, nullptr,
+                        nullptr, 0);
+#endif
+            }
         }
+
+        char* bytes() { return reinterpret_cast<char*>(buffer_.get()); }
+
+        uint64_t& header_at(size_t offset) { return buffer_[offset / sizeof(uint64_t)]; }
+
+        const size_t capacity_;
+        const size_t mask_;
+        std::unique_ptr<uint64_t[]> buffer_;
+
+        std::atomic<bool> doorbell_enabled_{false};
+
+        // producer side
+        alignas(64) std::atomic<uint64_t> write_index_{0};
+        uint64_t write_pos_ = 0;
+        uint64_t claim_pos_ = 0;
+        uint64_t cached_read_ = 0;
+
+        // consumer side
+        alignas(64) std::atomic<uint64_t> read_index_{0};
+        uint64_t read_pos_ = 0;
+        uint64_t cached_write_ = 0;
+
+        // shared by both sides, only touched when the consumer parks
+        alignas(64) std::atomic<uint32_t> doorbell_{0};
+        std::atomic<bool> consumer_parked_{false};
     };
 
-    using MDRingBuffer = boost::lockfree::spsc_queue<MessageBuffer>;
+    using MDRingBuffer = ByteRing;
 }
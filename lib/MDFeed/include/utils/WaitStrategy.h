@@ -0,0 +1,97 @@
+#pragma once
+
+#include "common/TscClock.h"
+#include "utils/RingBuffer.h"
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace mdfeed
+{
+    enum class WaitStrategy : uint8_t
+    {
+        // pause-spin forever: lowest wake latency, one core at 100%
+        SPIN,
+        // pause-spin for spin_duration, then yield between polls
+        SPIN_YIELD,
+        // pause-spin for spin_duration, then sleep on the ring's doorbell until
+        // the producer commits or park_timeout passes
+        SPIN_PARK
+    };
+
+    enum class SchedulerPolicy : uint8_t
+    {
+        OTHER,
+        FIFO,
+        ROUND_ROBIN
+    };
+
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Idle handling for a ring consumer. idle() is called on every empty poll
+    // and reset() whenever a poll finds work, which restarts the spin phase.
+    class IdleWaiter
+    {
+    public:
+        IdleWaiter(WaitStrategy strategy, std::chrono::microseconds spin_duration,
+                   std::chrono::microseconds park_timeout, ByteRing* ring)
+            : strategy_(strategy)
+              , spin_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(spin_duration).count())
+              , park_timeout_(park_timeout)
+              , ring_(ring)
+        {
+            if (strategy_ == WaitStrategy::SPIN_PARK && ring_)
+            {
+                ring_->enable_doorbell();
+            }
+        }
+
+        void reset() { spinning_since_ = 0; }
+
+        // returns true if the thread parked, i.e. was not spinning
+        bool idle()
+        {
+            auto& clock = common::TscClock::instance();
+            const uint64_t now = clock.ticks();
+            if (spinning_since_ == 0)
+            {
+                spinning_since_ = now;
+            }
+            if (strategy_ == WaitStrategy::SPIN || clock.ticks_to_ns(now - spinning_since_) < spin_ns_)
+            {
+                for (int i = 0; i < SPINS_PER_POLL; ++i)
+                {
+                    cpu_relax();
+                }
+                return false;
+            }
+            if (strategy_ == WaitStrategy::SPIN_PARK && ring_)
+            {
+                ring_->wait_for_data(park_timeout_);
+                return true;
+            }
+            std::this_thread::yield();
+            return true;
+        }
+
+    private:
+        static constexpr int SPINS_PER_POLL = 16;
+
+        WaitStrategy strategy_;
+        uint64_t spin_ns_;
+        std::chrono::microseconds park_timeout_;
+        ByteRing* ring_;
+        uint64_t spinning_since_ = 0;
+    };
+}
@@ -23,7 +23,8 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
             .value("SNAPSHOT_BEGIN", mdfeed::MessageType::SNAPSHOT_BEGIN)
             .value("SNAPSHOT_ENTRY", mdfeed::MessageType::SNAPSHOT_ENTRY)
             .value("SNAPSHOT_END", mdfeed::MessageType::SNAPSHOT_END)
-            .value("BOOK_CLEAR", mdfeed::MessageType::BOOK_CLEAR);
+            .value("BOOK_CLEAR", mdfeed::MessageType::BOOK_CLEAR)
+            .value("STATISTICS", mdfeed::MessageType::STATISTICS);
 
     py::enum_<mdfeed::Side>(m, "MDSide")
             .value("BUY", mdfeed::Side::BUY)
@@ -34,6 +35,11 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
             .value("CHANGE", mdfeed::UpdateAction::CHANGE)
             .value("DELETE", mdfeed::UpdateAction::DELETE);
 
+    py::enum_<mdfeed::FeedState>(m, "FeedState")
+            .value("LIVE", mdfeed::FeedState::LIVE)
+            .value("RECOVERING", mdfeed::FeedState::RECOVERING)
+            .value("STALE", mdfeed::FeedState::STALE);
+
     // MessageHeader
     py::class_<mdfeed::MessageHeader>(m, "MessageHeader")
             .def_readonly("sequence_number",
@@ -49,6 +55,7 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
     // Message types
     py::class_<mdfeed::HeartbeatMessage>(m, "HeartbeatMessage")
             .def_readonly("header", &mdfeed::HeartbeatMessage::header)
+            .def_readonly("checksum", &mdfeed::HeartbeatMessage::checksum)
             .def("to_debug_string", &mdfeed::HeartbeatMessage::toDebugString);
 
     py::class_<mdfeed::PriceLevelUpdateMessage>(m, "PriceLevelUpdateMessage")
@@ -102,6 +109,34 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
             .def_readonly("reason_code", &mdfeed::BookClearMessage::reason_code)
             .def("to_debug_string", &mdfeed::BookClearMessage::toDebugString);
 
+    py::class_<mdfeed::StatisticsMessage>(m, "StatisticsMessage")
+            .def_readonly("header", &mdfeed::StatisticsMessage::header)
+            .def_readonly("session_open",
+                          &mdfeed::StatisticsMessage::session_open)
+            .def_readonly("session_high",
+                          &mdfeed::StatisticsMessage::session_high)
+            .def_readonly("session_low", &mdfeed::StatisticsMessage::session_low)
+            .def_readonly("session_close",
+                          &mdfeed::StatisticsMessage::session_close)
+            .def_readonly("session_volume",
+                          &mdfeed::StatisticsMessage::session_volume)
+            .def_readonly("session_vwap",
+                          &mdfeed::StatisticsMessage::session_vwap)
+            .def_readonly("session_trade_count",
+                          &mdfeed::StatisticsMessage::session_trade_count)
+            .def_readonly("window_open", &mdfeed::StatisticsMessage::window_open)
+            .def_readonly("window_high", &mdfeed::StatisticsMessage::window_high)
+            .def_readonly("window_low", &mdfeed::StatisticsMessage::window_low)
+            .def_readonly("window_close",
+                          &mdfeed::StatisticsMessage::window_close)
+            .def_readonly("window_volume",
+                          &mdfeed::StatisticsMessage::window_volume)
+            .def_readonly("window_vwap", &mdfeed::StatisticsMessage::window_vwap)
+            .def_readonly("window_trade_count",
+                          &mdfeed::StatisticsMessage::window_trade_count)
+            .def_readonly("window_ms", &mdfeed::StatisticsMessage::window_ms)
+            .def("to_debug_string", &mdfeed::StatisticsMessage::toDebugString);
+
     // ReceiverConfig
     py::class_<mdfeed::ReceiverConfig>(m, "ReceiverConfig")
             .def(py::init<>())
@@ -113,29 +148,90 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
                            &mdfeed::ReceiverConfig::interface_ip)
             .def_readwrite("receive_buffer_size",
                            &mdfeed::ReceiverConfig::receive_buffer_size)
+            .def_readwrite("receive_batch_size",
+                           &mdfeed::ReceiverConfig::receive_batch_size)
+            .def_readwrite("busy_poll", &mdfeed::ReceiverConfig::busy_poll)
+            .def_readwrite("kernel_timestamps",
+                           &mdfeed::ReceiverConfig::kernel_timestamps)
             .def_readwrite("enable_logging",
                            &mdfeed::ReceiverConfig::enable_logging)
             .def_readwrite("log_to_console",
                            &mdfeed::ReceiverConfig::log_to_console)
             .def_readwrite("log_file_path",
                            &mdfeed::ReceiverConfig::log_file_path)
+            .def_readwrite("journal_buffer_bytes",
+                           &mdfeed::ReceiverConfig::journal_buffer_bytes)
+            .def_readwrite("journal_flush_interval",
+                           &mdfeed::ReceiverConfig::journal_flush_interval)
             .def_readwrite("validate_sequence_numbers",
                            &mdfeed::ReceiverConfig::validate_sequence_numbers)
+            .def_readwrite("instruments", &mdfeed::ReceiverConfig::instruments)
+            .def_readwrite("retransmit_ip",
+                           &mdfeed::ReceiverConfig::retransmit_ip)
+            .def_readwrite("retransmit_port",
+                           &mdfeed::ReceiverConfig::retransmit_port)
+            .def_readwrite("retransmit_timeout",
+                           &mdfeed::ReceiverConfig::retransmit_timeout)
+            .def_readwrite("snapshot_ip", &mdfeed::ReceiverConfig::snapshot_ip)
+            .def_readwrite("snapshot_port",
+                           &mdfeed::ReceiverConfig::snapshot_port)
+            .def_readwrite("recovery_queue_bytes",
+                           &mdfeed::ReceiverConfig::recovery_queue_bytes)
+            .def_readwrite("recovery_timeout",
+                           &mdfeed::ReceiverConfig::recovery_timeout)
             .def_readwrite("stats_interval",
                            &mdfeed::ReceiverConfig::stats_interval);
 
+    py::class_<mdfeed::LatencySummary>(m, "LatencySummary")
+            .def_readonly("count", &mdfeed::LatencySummary::count)
+            .def_readonly("p50_ns", &mdfeed::LatencySummary::p50_ns)
+            .def_readonly("p99_ns", &mdfeed::LatencySummary::p99_ns)
+            .def_readonly("p999_ns", &mdfeed::LatencySummary::p999_ns)
+            .def_readonly("max_ns", &mdfeed::LatencySummary::max_ns);
+
     // Stats
     py::class_<mdfeed::MulticastReceiver::Stats>(m, "ReceiverStats")
             .def_readonly(
                     "total_messages_received",
                     &mdfeed::MulticastReceiver::Stats::total_messages_received)
+            .def_readonly(
+                    "total_packets_received",
+                    &mdfeed::MulticastReceiver::Stats::total_packets_received)
             .def_readonly(
                     "total_bytes_received",
                     &mdfeed::MulticastReceiver::Stats::total_bytes_received)
             .def_readonly("sequence_gaps",
                           &mdfeed::MulticastReceiver::Stats::sequence_gaps)
+            .def_readonly("messages_recovered",
+                          &mdfeed::MulticastReceiver::Stats::messages_recovered)
+            .def_readonly("recovery_failures",
+                          &mdfeed::MulticastReceiver::Stats::recovery_failures)
+            .def_readonly("recoveries",
+                          &mdfeed::MulticastReceiver::Stats::recoveries)
+            .def_readonly("snapshot_recoveries",
+                          &mdfeed::MulticastReceiver::Stats::snapshot_recoveries)
+            .def_readonly("messages_replayed",
+                          &mdfeed::MulticastReceiver::Stats::messages_replayed)
+            .def_readonly("stale_transitions",
+                          &mdfeed::MulticastReceiver::Stats::stale_transitions)
+            .def_readonly("heartbeats_received",
+                          &mdfeed::MulticastReceiver::Stats::heartbeats_received)
             .def_readonly("invalid_messages",
                           &mdfeed::MulticastReceiver::Stats::invalid_messages)
+            .def_readonly("filtered_messages",
+                          &mdfeed::MulticastReceiver::Stats::filtered_messages)
+            .def_readonly("receive_batches",
+                          &mdfeed::MulticastReceiver::Stats::receive_batches)
+            .def_readonly("max_batch_size",
+                          &mdfeed::MulticastReceiver::Stats::max_batch_size)
+            .def_readonly("log_entries_dropped",
+                          &mdfeed::MulticastReceiver::Stats::log_entries_dropped)
+            .def_readonly("publish_to_wire",
+                          &mdfeed::MulticastReceiver::Stats::publish_to_wire)
+            .def_readonly("wire_to_user",
+                          &mdfeed::MulticastReceiver::Stats::wire_to_user)
+            .def("average_batch_size",
+                 &mdfeed::MulticastReceiver::Stats::average_batch_size)
             .def_readonly("start_time",
                           &mdfeed::MulticastReceiver::Stats::start_time);
 
@@ -150,6 +246,8 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
             .def("stop", &mdfeed::MulticastReceiver::stop, "Stop the receiver")
             .def("is_running", &mdfeed::MulticastReceiver::is_running,
                  "Check if receiver is running")
+            .def("feed_state", &mdfeed::MulticastReceiver::feed_state,
+                 "LIVE, RECOVERING or STALE")
             .def("set_message_handler",
                  &mdfeed::MulticastReceiver::set_message_handler,
                  "Set custom message handler function", py::arg("handler"))
@@ -199,6 +297,10 @@ PYBIND11_MODULE(_mdfeed_receiver, m)
                     return py::cast(
                             *reinterpret_cast<const mdfeed::BookClearMessage*>(
                                     data_ptr));
+                case mdfeed::MessageType::STATISTICS:
+                    return py::cast(*reinterpret_cast<
+                                    const mdfeed::StatisticsMessage*>(
+                            data_ptr));
                 default:
                     return py::none();
                 }
@@ -0,0 +1,163 @@
+#include "publisher/MarketDataChannels.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace mdfeed
+{
+    MarketDataChannels::MarketDataChannels(const PublisherConfig& config)
+        : config_(config)
+    {
+        config_.channel_count = std::max<size_t>(config_.channel_count, 1);
+        for (const auto& [instrument_id, channel] : config_.instrument_channels)
+        {
+            // channel_of would quietly move the instrument to channel 0, whose subscribers do not expect it
+            if (channel >= config_.channel_count)
+            {
+                throw std::invalid_argument("instrument " + std::to_string(instrument_id) + " mapped to channel "
+                    + std::to_string(channel) + " of " + std::to_string(config_.channel_count));
+            }
+        }
+        channels_.reserve(config_.channel_count);
+        for (size_t channel = 0; channel < config_.channel_count; ++channel)
+        {
+            Channel entry{config_.for_channel(channel), nullptr, nullptr, nullptr, nullptr};
+            entry.publisher = std::make_unique<MarketDataPublisher>(entry.config);
+            entry.sender = std::make_unique<MulticastPublisherThread>(entry.publisher->get_ring_buffer(),
+                                                                      entry.config);
+            if (entry.config.retransmit_port != 0 && entry.config.retransmit_packets > 0)
+            {
+                entry.retransmit = std::make_unique<RetransmitServer>(entry.config);
+                entry.sender->set_retransmit_store(entry.retransmit->store());
+            }
+            if (entry.config.snapshot_port != 0)
+            {
+                entry.snapshots = std::make_unique<SnapshotPublisherThread>(entry.config);
+                entry.sender->set_snapshot_publisher(entry.snapshots.get());
+            }
+            channels_.push_back(std::move(entry));
+        }
+    }
+
+    MarketDataChannels::~MarketDataChannels()
+    {
+        stop();
+    }
+
+    bool MarketDataChannels::start()
+    {
+        for (size_t channel = 0; channel < channels_.size(); ++channel)
+        {
+            Channel& entry = channels_[channel];
+            if ((entry.snapshots && !entry.snapshots->start()) || (entry.retransmit && !entry.retransmit->start())
+                || !entry.sender->start())
+            {
+                stop();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MarketDataChannels::stop()
+    {
+        for (Channel& channel : channels_)
+        {
+            channel.sender->stop();
+            if (channel.retransmit)
+            {
+                channel.retransmit->stop();
+            }
+            if (channel.snapshots)
+            {
+                channel.snapshots->stop();
+            }
+        }
+    }
+
+    MarketDataPublisher& MarketDataChannels::publisher_for(uint32_t instrument_id)
+    {
+        return *channels_[config_.channel_of(instrument_id)].publisher;
+    }
+
+    void MarketDataChannels::flush_conflated()
+    {
+        for (Channel& channel : channels_)
+        {
+            channel.publisher->flush_conflated();
+        }
+    }
+
+    MulticastPublisherThread::Stats MarketDataChannels::get_stats() const
+    {
+        MulticastPublisherThread::Stats total;
+        for (const Channel& channel : channels_)
+        {
+            const auto stats = channel.sender->get_stats();
+            total.messages_sent += stats.messages_sent;
+            total.packets_sent += stats.packets_sent;
+            total.send_failures += stats.send_failures;
+            total.ring_buffer_empty_count += stats.ring_buffer_empty_count;
+            total.bursts_sent += stats.bursts_sent;
+            total.partial_bursts += stats.partial_bursts;
+            total.max_burst_size = std::max(total.max_burst_size, stats.max_burst_size);
+            total.heartbeats_sent += stats.heartbeats_sent;
+            total.statistics_sent += stats.statistics_sent;
+            total.oversized_messages += stats.oversized_messages;
+            total.idle_parks += stats.idle_parks;
+        }
+        return total;
+    }
+
+    MarketDataPublisher::Stats MarketDataChannels::get_publisher_stats() const
+    {
+        MarketDataPublisher::Stats total;
+        for (const Channel& channel : channels_)
+        {
+            const auto stats = channel.publisher->get_stats();
+            total.messages_published += stats.messages_published;
+            total.messages_dropped += stats.messages_dropped;
+            total.updates_conflated += stats.updates_conflated;
+            total.conflated_levels_sent += stats.conflated_levels_sent;
+        }
+        return total;
+    }
+
+    RetransmitServer::Stats MarketDataChannels::get_retransmit_stats() const
+    {
+        RetransmitServer::Stats total;
+        for (const Channel& channel : channels_)
+        {
+            if (!channel.retransmit)
+            {
+                continue;
+            }
+            const auto stats = channel.retransmit->get_stats();
+            total.connections += stats.connections;
+            total.requests += stats.requests;
+            total.packets_resent += stats.packets_resent;
+            total.requests_too_old += stats.requests_too_old;
+        }
+        return total;
+    }
+
+    SnapshotPublisherThread::Stats MarketDataChannels::get_snapshot_stats() const
+    {
+        SnapshotPublisherThread::Stats total;
+        for (const Channel& channel : channels_)
+        {
+            if (!channel.snapshots)
+            {
+                continue;
+            }
+            const auto stats = channel.snapshots->get_stats();
+            total.cycles += stats.cycles;
+            total.snapshots_sent += stats.snapshots_sent;
+            total.entries_sent += stats.entries_sent;
+            total.packets_sent += stats.packets_sent;
+            total.send_failures += stats.send_failures;
+            total.oversized_messages += stats.oversized_messages;
+        }
+        return total;
+    }
+}
@@ -1,12 +1,14 @@
 #include "publisher/MarketDataPublisher.h"
-#include <cstring>
 
 namespace mdfeed
 {
     MarketDataPublisher::MarketDataPublisher(const PublisherConfig& config)
         : config_(config)
-          , ring_buffer_(std::make_unique<MDRingBuffer>(config_.ring_buffer_size))
+          , ring_buffer_(std::make_unique<MDRingBuffer>(config_.ring_buffer_bytes))
+          , pending_levels_(config_.conflate_on_backpressure ? config_.conflation_capacity : 0)
     {
+        // calibrate now rather than on the matching thread's first timestamp
+        common::TscClock::instance();
     }
 
     MarketDataPublisher::~MarketDataPublisher() = default;
@@ -14,50 +16,139 @@ namespace mdfeed
     bool MarketDataPublisher::publish_price_level_update(uint32_t instrument_id, uint64_t price,
                                                          uint64_t quantity, Side side, UpdateAction action)
     {
-        PriceLevelUpdateMessage msg{};
-        message_utils::init_header(msg, MessageType::PRICE_LEVEL_UPDATE, sequence_number_++, instrument_id);
-        msg.price = price;
-        msg.quantity = quantity;
-        msg.side = side;
-        msg.action = action;
-        std::memset(msg.reserved, 0, sizeof(msg.reserved));
-
-        return enqueue_message(msg);
+        if (config_.conflate_on_backpressure)
+        {
+            return publish_conflated_level({instrument_id, side, price}, quantity, action != UpdateAction::NEW);
+        }
+        return emplace_message<PriceLevelUpdateMessage>(
+            MessageType::PRICE_LEVEL_UPDATE, instrument_id, [&](PriceLevelUpdateMessage& msg)
+            {
+                msg.price = price;
+                msg.quantity = quantity;
+                msg.side = side;
+                msg.action = action;
+            });
     }
 
     bool MarketDataPublisher::publish_price_level_delete(uint32_t instrument_id, uint64_t price, Side side)
     {
-        PriceLevelDeleteMessage msg{};
-        message_utils::init_header(msg, MessageType::PRICE_LEVEL_DELETE, sequence_number_++, instrument_id);
-        msg.price = price;
-        msg.side = side;
-        std::memset(msg.reserved, 0, sizeof(msg.reserved));
+        if (config_.conflate_on_backpressure)
+        {
+            return publish_conflated_level({instrument_id, side, price}, 0, true);
+        }
+        return emplace_message<PriceLevelDeleteMessage>(
+            MessageType::PRICE_LEVEL_DELETE, instrument_id, [&](PriceLevelDeleteMessage& msg)
+            {
+                msg.price = price;
+                msg.side = side;
+            });
+    }
+
+    bool MarketDataPublisher::try_write_level(const LevelKey& key, uint64_t quantity, UpdateAction action)
+    {
+        bool written;
+        if (quantity == 0)
+        {
+            written = try_emplace<PriceLevelDeleteMessage>(
+                MessageType::PRICE_LEVEL_DELETE, sequence_number_, key.instrument_id,
+                [&](PriceLevelDeleteMessage& msg)
+                {
+                    msg.price = key.price;
+                    msg.side = key.side;
+                });
+        }
+        else
+        {
+            written = try_emplace<PriceLevelUpdateMessage>(
+                MessageType::PRICE_LEVEL_UPDATE, sequence_number_, key.instrument_id,
+                [&](PriceLevelUpdateMessage& msg)
+                {
+                    msg.price = key.price;
+                    msg.quantity = quantity;
+                    msg.side = key.side;
+                    msg.action = action;
+                });
+        }
+        if (written)
+        {
+            sequence_number_++;
+        }
+        return written;
+    }
 
-        return enqueue_message(msg);
+    bool MarketDataPublisher::publish_conflated_level(const LevelKey& key, uint64_t quantity, bool existed_before)
+    {
+        if (!pending_levels_.empty())
+        {
+            const uint64_t now = message_utils::get_timestamp_ns();
+            if (now - last_drain_ns_ >= static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(config_.conflation_interval).count()))
+            {
+                last_drain_ns_ = now;
+                flush_conflated();
+            }
+        }
+        // while levels are pending everything goes through the table so a level's states stay in order
+        if (pending_levels_.empty()
+            && try_write_level(key, quantity, existed_before ? UpdateAction::CHANGE : UpdateAction::NEW))
+        {
+            return true;
+        }
+        if (!pending_levels_.upsert(key, quantity, existed_before))
+        {
+            // receivers see the lost level as a gap and recover the book
+            sequence_number_++;
+            stats_.messages_dropped++;
+            stats_.conflation_table_full++;
+            return false;
+        }
+        stats_.updates_conflated++;
+        return true;
+    }
+
+    bool MarketDataPublisher::flush_conflated()
+    {
+        return pending_levels_.drain([this](const LevelKey& key, const ConflationTable::Level& level)
+        {
+            // a level that appeared and vanished while pending never reaches receivers
+            if (level.quantity > 0 || level.existed_before)
+            {
+                const UpdateAction action = level.existed_before ? UpdateAction::CHANGE : UpdateAction::NEW;
+                if (!try_write_level(key, level.quantity, action))
+                {
+                    return false;
+                }
+                stats_.conflated_levels_sent++;
+            }
+            return true;
+        });
     }
 
     bool MarketDataPublisher::publish_trade(uint32_t instrument_id, uint64_t trade_id, uint64_t price,
                                             uint64_t quantity, Side aggressor_side)
     {
-        TradeMessage msg{};
-        message_utils::init_header(msg, MessageType::TRADE, sequence_number_++, instrument_id);
-        msg.trade_id = trade_id;
-        msg.price = price;
-        msg.quantity = quantity;
-        msg.aggressor_side = aggressor_side;
-        std::memset(msg.reserved, 0, sizeof(msg.reserved));
-
-        return enqueue_message(msg);
+        return emplace_message<TradeMessage>(
+            MessageType::TRADE, instrument_id, [&](TradeMessage& msg)
+            {
+                msg.trade_id = trade_id;
+                msg.price = price;
+                msg.quantity = quantity;
+                msg.aggressor_side = aggressor_side;
+            });
     }
 
     bool MarketDataPublisher::publish_book_clear(uint32_t instrument_id, uint32_t reason_code)
     {
-        BookClearMessage msg{};
-        message_utils::init_header(msg, MessageType::BOOK_CLEAR, sequence_number_++, instrument_id);
-        msg.reason_code = reason_code;
-        std::memset(msg.reserved, 0, sizeof(msg.reserved));
-
-        return enqueue_message(msg);
+        // pending levels of a cleared book are stale
+        pending_levels_.erase_if([instrument_id](const LevelKey& key)
+        {
+            return key.instrument_id == instrument_id;
+        });
+        return emplace_message<BookClearMessage>(
+            MessageType::BOOK_CLEAR, instrument_id, [&](BookClearMessage& msg)
+            {
+                msg.reason_code = reason_code;
+            });
     }
 
     MDRingBuffer* MarketDataPublisher::get_ring_buffer() const
@@ -4,10 +4,11 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <sys/uio.h>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
-#include <iostream>
+#include <vector>
 
 namespace mdfeed {
     class MulticastSocket {
@@ -71,6 +72,39 @@ namespace mdfeed {
             return bytes_sent == static_cast<ssize_t>(length);
         }
 
+        std::size_t send_batch(const Datagram *datagrams, std::size_t count) {
+            if (socket_fd_ < 0 || count == 0) {
+                return 0;
+            }
+#ifdef __linux__
+            if (iovecs_.size() < count) {
+                iovecs_.resize(count);
+                headers_.resize(count);
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                iovecs_[i].iov_base = const_cast<void *>(datagrams[i].data);
+                iovecs_[i].iov_len = datagrams[i].length;
+                headers_[i] = mmsghdr{};
+                headers_[i].msg_hdr.msg_name = &multicast_addr_;
+                headers_[i].msg_hdr.msg_namelen = sizeof(multicast_addr_);
+                headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+                headers_[i].msg_hdr.msg_iovlen = 1;
+            }
+            int sent = sendmmsg(socket_fd_, headers_.data(), static_cast<unsigned int>(count), 0);
+            if (sent < 0) {
+                perror("Failed to send data to multicast socket");
+                return 0;
+            }
+            return static_cast<std::size_t>(sent);
+#else
+            std::size_t sent = 0;
+            while (sent < count && send_data(datagrams[sent].data, datagrams[sent].length)) {
+                sent++;
+            }
+            return sent;
+#endif
+        }
+
         void close() {
             if (socket_fd_ >= 0) {
                 ::close(socket_fd_);
@@ -83,6 +117,10 @@ namespace mdfeed {
     private:
         int socket_fd_;
         struct sockaddr_in multicast_addr_{};
+#ifdef __linux__
+        std::vector<iovec> iovecs_;
+        std::vector<mmsghdr> headers_;
+#endif
     };
 
     MulticastPublisher::MulticastPublisher()
@@ -128,4 +166,12 @@ namespace mdfeed {
 
         return socket_->send_data(data, length);
     }
+
+    std::size_t MulticastPublisher::send_batch(const Datagram *datagrams, std::size_t count) {
+        if (!initialized_ || !socket_) {
+            return 0;
+        }
+
+        return socket_->send_batch(datagrams, count);
+    }
 }
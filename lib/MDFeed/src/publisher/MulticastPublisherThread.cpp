@@ -1,12 +1,74 @@
 #include "publisher/MulticastPublisherThread.h"
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace mdfeed
 {
+    namespace
+    {
+        bool pin_current_thread(int cpu)
+        {
+#ifdef __linux__
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+            (void)cpu;
+            return false;
+#endif
+        }
+
+        bool set_current_thread_scheduler(SchedulerPolicy policy, int priority)
+        {
+#ifdef __linux__
+            sched_param param{};
+            param.sched_priority = policy == SchedulerPolicy::OTHER ? 0 : priority;
+            const int native = policy == SchedulerPolicy::FIFO
+                                   ? SCHED_FIFO
+                                   : policy == SchedulerPolicy::ROUND_ROBIN ? SCHED_RR : SCHED_OTHER;
+            return pthread_setschedparam(pthread_self(), native, &param) == 0;
+#else
+            (void)policy;
+            (void)priority;
+            return false;
+#endif
+        }
+
+        void fill_statistics_message(StatisticsMessage& msg, const TradeSummary& summary)
+        {
+            msg.session_open = summary.session.open;
+            msg.session_high = summary.session.high;
+            msg.session_low = summary.session.low;
+            msg.session_close = summary.session.close;
+            msg.session_volume = summary.session.volume;
+            msg.session_vwap = summary.session.vwap();
+            msg.window_open = summary.window.open;
+            msg.window_high = summary.window.high;
+            msg.window_low = summary.window.low;
+            msg.window_close = summary.window.close;
+            msg.window_volume = summary.window.volume;
+            msg.window_vwap = summary.window.vwap();
+            msg.session_trade_count = summary.session.trade_count;
+            msg.window_trade_count = summary.window.trade_count;
+            msg.window_ms = summary.window_ms;
+        }
+    }
+
     MulticastPublisherThread::MulticastPublisherThread(MDRingBuffer* ring_buffer, const PublisherConfig& config)
         : ring_buffer_(ring_buffer)
           , config_(config)
+          , packets_(std::max<size_t>(config.max_burst_datagrams, 1),
+                     PacketBuilder(config.max_packet_size,
+                                   config.compact_encoding ? PacketFormat::COMPACT : PacketFormat::PLAIN,
+                                   config.price_tick))
+          , datagrams_(packets_.size())
           , running_(false)
     {
     }
@@ -38,6 +100,7 @@ namespace mdfeed
 
         running_.store(true);
         stats_ = Stats{};
+        track_books_ = config_.heartbeat_checksums || snapshots_ != nullptr;
 
         publisher_thread_ = std::thread(&MulticastPublisherThread::publisher_loop, this);
 
@@ -64,52 +127,276 @@ namespace mdfeed
         multicast_publisher_.close();
 
         std::cout << "MulticastPublisherThread stopped. Messages sent: "
-            << stats_.messages_sent << ", Failures: " << stats_.send_failures << std::endl;
+            << stats_.messages_sent << ", Packets sent: " << stats_.packets_sent
+            << ", Bursts: " << stats_.bursts_sent << ", Failures: " << stats_.send_failures << std::endl;
+    }
+
+    void MulticastPublisherThread::fill_packet(PacketBuilder& packet)
+    {
+        packet.reset();
+        while (const ByteRing::Record message = ring_buffer_->peek())
+        {
+            if (!packet.fits(message.length))
+            {
+                if (!packet.empty())
+                {
+                    break;
+                }
+                // over the byte budget on its own; its sequence number is still consumed,
+                // so receivers see the drop as a gap
+                stats_.oversized_messages++;
+            }
+            else
+            {
+                packet.append(message.data, message.length);
+            }
+            const auto* header = static_cast<const MessageHeader*>(message.data);
+            last_sequence_number_ = header->sequence_number;
+            if (track_books_)
+            {
+                books_.apply(*header, message.data);
+            }
+            if (config_.statistics_interval.count() > 0
+                && header->message_type == static_cast<uint16_t>(MessageType::TRADE))
+            {
+                const auto* trade = static_cast<const TradeMessage*>(message.data);
+                trade_statistics_.try_emplace(header->instrument_id, config_.statistics_bucket_width)
+                                 .first->second.on_trade(trade->price, trade->quantity, header->timestamp_ns);
+            }
+            ring_buffer_->release();
+        }
+    }
+
+    size_t MulticastPublisherThread::fill_burst()
+    {
+        size_t count = 0;
+        while (count < packets_.size())
+        {
+            PacketBuilder& packet = packets_[count];
+            fill_packet(packet);
+            if (packet.empty())
+            {
+                break;
+            }
+            const size_t length = packet.finish();
+            datagrams_[count] = Datagram{packet.data(), length};
+            if (retransmit_store_)
+            {
+                retransmit_store_->store(packet.data(), length);
+            }
+            count++;
+        }
+        return count;
+    }
+
+    void MulticastPublisherThread::send_burst(size_t count)
+    {
+        size_t sent = 0;
+        while (sent < count)
+        {
+            const size_t accepted = multicast_publisher_.send_batch(&datagrams_[sent], count - sent);
+            if (accepted == 0)
+            {
+                stats_.send_failures += count - sent;
+                std::cerr << "Failed to send multicast message" << std::endl;
+                break;
+            }
+            if (sent + accepted < count)
+            {
+                // the kernel took only part of the burst, resubmit the rest
+                stats_.partial_bursts++;
+            }
+            for (size_t i = sent; i < sent + accepted; ++i)
+            {
+                stats_.messages_sent += packets_[i].message_count();
+            }
+            sent += accepted;
+        }
+        stats_.packets_sent += sent;
+        stats_.bursts_sent++;
+        stats_.max_burst_size = std::max<uint64_t>(stats_.max_burst_size, count);
+    }
+
+    size_t MulticastPublisherThread::fill_heartbeats(std::optional<uint32_t>& next)
+    {
+        HeartbeatMessage heartbeat{};
+        message_utils::init_header(heartbeat, MessageType::HEARTBEAT, last_sequence_number_, 0);
+
+        size_t count = 0;
+        packets_[0].reset();
+        auto add = [&](uint32_t instrument_id, uint32_t checksum)
+        {
+            if (!packets_[count].fits(sizeof(heartbeat)))
+            {
+                if (packets_[count].empty() || count + 1 == packets_.size())
+                {
+                    return false;
+                }
+                packets_[++count].reset();
+            }
+            heartbeat.header.instrument_id = instrument_id;
+            heartbeat.checksum = checksum;
+            packets_[count].append(&heartbeat, sizeof(heartbeat));
+            stats_.heartbeats_sent++;
+            return true;
+        };
+
+        if (config_.heartbeat_checksums && books_.size() > 0)
+        {
+            uint32_t from = *next;
+            next = books_.for_each_checksum(from, add) ? std::optional<uint32_t>(from) : std::nullopt;
+        }
+        else
+        {
+            add(0, 0);
+            next.reset();
+        }
+
+        // nothing fits a budget smaller than one heartbeat
+        if (packets_[count].empty())
+        {
+            next.reset();
+            return 0;
+        }
+        for (size_t i = 0; i <= count; ++i)
+        {
+            datagrams_[i] = Datagram{packets_[i].data(), packets_[i].finish()};
+        }
+        return count + 1;
+    }
+
+    size_t MulticastPublisherThread::fill_statistics(std::map<uint32_t, TradeStatistics>::const_iterator& next,
+                                                     uint64_t now_ns)
+    {
+        StatisticsMessage statistics{};
+        message_utils::init_header(statistics, MessageType::STATISTICS, last_sequence_number_, 0);
+
+        size_t count = 0;
+        packets_[0].reset();
+        for (; next != trade_statistics_.end(); ++next)
+        {
+            if (!packets_[count].fits(sizeof(statistics)))
+            {
+                if (packets_[count].empty())
+                {
+                    // smaller budget than one message, none of them can be sent
+                    next = trade_statistics_.end();
+                    return 0;
+                }
+                if (count + 1 == packets_.size())
+                {
+                    break;
+                }
+                packets_[++count].reset();
+            }
+            statistics.header.instrument_id = next->first;
+            fill_statistics_message(statistics, next->second.summary(now_ns));
+            packets_[count].append(&statistics, sizeof(statistics));
+            stats_.statistics_sent++;
+        }
+
+        for (size_t i = 0; i <= count; ++i)
+        {
+            datagrams_[i] = Datagram{packets_[i].data(), packets_[i].finish()};
+        }
+        return count + 1;
+    }
+
+    void MulticastPublisherThread::publish_statistics(std::chrono::steady_clock::time_point now)
+    {
+        if (config_.statistics_interval.count() == 0 || trade_statistics_.empty()
+            || now - last_statistics_time_ < config_.statistics_interval)
+        {
+            return;
+        }
+        last_statistics_time_ = now;
+        const uint64_t now_ns = message_utils::get_timestamp_ns();
+        auto next = trade_statistics_.cbegin();
+        while (next != trade_statistics_.cend())
+        {
+            if (const size_t count = fill_statistics(next, now_ns); count > 0)
+            {
+                send_burst(count);
+            }
+        }
+    }
+
+    void MulticastPublisherThread::refresh_snapshot_images(std::chrono::steady_clock::time_point now)
+    {
+        if (!snapshots_ || now - last_image_time_ < config_.snapshot_interval)
+        {
+            return;
+        }
+        books_.refresh_images(images_, last_sequence_number_);
+        snapshots_->update_images(images_);
+        last_image_time_ = now;
     }
 
     void MulticastPublisherThread::publisher_loop()
     {
-        MessageBuffer message;
         auto last_stats_time = std::chrono::steady_clock::now();
+        last_send_time_ = last_stats_time;
         std::cout << "Publisher thread started" << std::endl;
+        if (config_.sender_cpu >= 0 && !pin_current_thread(config_.sender_cpu))
+        {
+            std::cerr << "Failed to pin publisher thread to CPU " << config_.sender_cpu << std::endl;
+        }
+        if (config_.sender_scheduler != SchedulerPolicy::OTHER
+            && !set_current_thread_scheduler(config_.sender_scheduler, config_.sender_priority))
+        {
+            std::cerr << "Failed to set publisher thread scheduling policy" << std::endl;
+        }
+        IdleWaiter waiter(config_.wait_strategy, config_.spin_duration, config_.park_timeout, ring_buffer_);
         while (running_.load(std::memory_order_relaxed))
         {
-            if (ring_buffer_->pop(message))
+            if (const size_t count = fill_burst(); count > 0)
             {
-                if (multicast_publisher_.send(message.data, message.length))
-                {
-                    stats_.messages_sent++;
+                send_burst(count);
+                waiter.reset();
 
-                    auto now = std::chrono::steady_clock::now();
-                    if (std::chrono::duration_cast<std::chrono::seconds>(now - last_stats_time).count() >= 5)
-                    {
-                        std::cout << "Publisher stats - Sent: " << stats_.messages_sent
-                            << ", Failures: " << stats_.send_failures
-                            << ", Empty polls: " << stats_.ring_buffer_empty_count << std::endl;
-                        last_stats_time = now;
-                    }
-                }
-                else
+                auto now = std::chrono::steady_clock::now();
+                last_send_time_ = now;
+                refresh_snapshot_images(now);
+                publish_statistics(now);
+                if (std::chrono::duration_cast<std::chrono::seconds>(now - last_stats_time).count() >= 5)
                 {
-                    stats_.send_failures++;
-                    std::cerr << "Failed to send multicast message" << std::endl;
+                    std::cout << "Publisher stats - Sent: " << stats_.messages_sent
+                        << ", Packets: " << stats_.packets_sent
+                        << ", Avg burst: " << stats_.average_burst_size()
+                        << ", Max burst: " << stats_.max_burst_size
+                        << ", Partial bursts: " << stats_.partial_bursts
+                        << ", Failures: " << stats_.send_failures
+                        << ", Empty polls: " << stats_.ring_buffer_empty_count << std::endl;
+                    last_stats_time = now;
+                    // every channel's sender does this; the clock skips a call that overlaps another
+                    common::TscClock::instance().recalibrate();
                 }
             }
             else
             {
                 stats_.ring_buffer_empty_count++;
 
-                if (config_.use_busy_wait)
+                auto now = std::chrono::steady_clock::now();
+                if (config_.heartbeat_interval.count() > 0 && now - last_send_time_ >= config_.heartbeat_interval)
                 {
-                    auto start = std::chrono::high_resolution_clock::now();
-                    while (std::chrono::high_resolution_clock::now() - start < config_.spin_duration)
+                    // as many bursts as it takes, so every instrument's checksum goes out
+                    std::optional<uint32_t> next = 0;
+                    while (next)
                     {
+                        if (const size_t count = fill_heartbeats(next); count > 0)
+                        {
+                            send_burst(count);
+                        }
                     }
+                    last_send_time_ = now;
                 }
-                else
+                refresh_snapshot_images(now);
+                // not counted as a send, heartbeats still carry the checksums on an idle feed
+                publish_statistics(now);
+
+                if (waiter.idle())
                 {
-                    // Yield to other threads
-                    std::this_thread::yield();
+                    stats_.idle_parks++;
                 }
             }
         }
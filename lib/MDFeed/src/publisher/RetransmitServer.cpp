@@ -0,0 +1,239 @@
+#include "publisher/RetransmitServer.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace mdfeed
+{
+    RetransmitServer::RetransmitServer(const PublisherConfig& config)
+        : config_(config)
+          , store_(config.retransmit_packets)
+          , listen_fd_(-1)
+          , running_(false)
+    {
+    }
+
+    RetransmitServer::~RetransmitServer()
+    {
+        stop();
+    }
+
+    bool RetransmitServer::start()
+    {
+        if (running_.load())
+        {
+            return true;
+        }
+
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ < 0)
+        {
+            std::cerr << "Failed to create retransmit socket" << std::endl;
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(config_.retransmit_port);
+        if (inet_aton(config_.interface_ip.c_str(), &address.sin_addr) == 0
+            || bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0
+            || listen(listen_fd_, 16) < 0)
+        {
+            std::cerr << "Failed to listen for retransmit requests on " << config_.interface_ip << ":"
+                << config_.retransmit_port << std::endl;
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+            return false;
+        }
+
+        running_.store(true);
+        stats_ = Stats{};
+        server_thread_ = std::thread(&RetransmitServer::server_loop, this);
+
+        std::cout << "RetransmitServer started - serving " << store_.capacity() << " packets on "
+            << config_.interface_ip << ":" << config_.retransmit_port << std::endl;
+        return true;
+    }
+
+    void RetransmitServer::stop()
+    {
+        if (!running_.load())
+        {
+            return;
+        }
+
+        running_.store(false);
+        if (server_thread_.joinable())
+        {
+            server_thread_.join();
+        }
+
+        for (const Connection& connection : connections_)
+        {
+            ::close(connection.fd);
+        }
+        connections_.clear();
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+
+        std::cout << "RetransmitServer stopped. Requests: " << stats_.requests
+            << ", Packets resent: " << stats_.packets_resent << std::endl;
+    }
+
+    void RetransmitServer::server_loop()
+    {
+        std::vector<pollfd> fds;
+        while (running_.load(std::memory_order_relaxed))
+        {
+            fds.clear();
+            fds.push_back(pollfd{listen_fd_, POLLIN, 0});
+            for (const Connection& connection : connections_)
+            {
+                const short events = connection.response.empty() ? POLLIN : POLLOUT;
+                fds.push_back(pollfd{connection.fd, events, 0});
+            }
+
+            // the timeout bounds how long stop() waits for the loop to notice
+            if (poll(fds.data(), fds.size(), 100) <= 0)
+            {
+                continue;
+            }
+
+            // fds[i + 1] belongs to connections_[i]; accepted clients are appended after this
+            size_t kept = 0;
+            for (size_t i = 0; i < connections_.size(); ++i)
+            {
+                Connection& connection = connections_[i];
+                const short revents = fds[i + 1].revents;
+                bool open = true;
+                if (revents != 0)
+                {
+                    open = connection.response.empty() ? read_request(connection) : write_response(connection);
+                }
+                if (!open)
+                {
+                    ::close(connection.fd);
+                    continue;
+                }
+                if (kept != i)
+                {
+                    connections_[kept] = std::move(connection);
+                }
+                kept++;
+            }
+            connections_.resize(kept);
+
+            if (fds[0].revents & POLLIN)
+            {
+                accept_client();
+            }
+        }
+    }
+
+    void RetransmitServer::accept_client()
+    {
+        const int client_fd = accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0)
+        {
+            return;
+        }
+        if (fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL, 0) | O_NONBLOCK) < 0)
+        {
+            ::close(client_fd);
+            return;
+        }
+        int no_delay = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        Connection connection;
+        connection.fd = client_fd;
+        connections_.push_back(std::move(connection));
+        stats_.connections++;
+    }
+
+    bool RetransmitServer::read_request(Connection& connection)
+    {
+        auto* bytes = reinterpret_cast<char*>(&connection.request);
+        while (connection.received < sizeof(RetransmitRequest))
+        {
+            const ssize_t result = recv(connection.fd, bytes + connection.received,
+                                        sizeof(RetransmitRequest) - connection.received, 0);
+            if (result > 0)
+            {
+                connection.received += static_cast<size_t>(result);
+                continue;
+            }
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            // the rest of the request comes with a later POLLIN
+            return result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        connection.received = 0;
+        build_response(connection);
+        return write_response(connection);
+    }
+
+    bool RetransmitServer::write_response(Connection& connection)
+    {
+        while (connection.sent < connection.response.size())
+        {
+            const ssize_t result = send(connection.fd, connection.response.data() + connection.sent,
+                                        connection.response.size() - connection.sent, MSG_NOSIGNAL);
+            if (result > 0)
+            {
+                connection.sent += static_cast<size_t>(result);
+                continue;
+            }
+            if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            // the rest goes out with a later POLLOUT
+            return result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        connection.response.clear();
+        connection.sent = 0;
+        return true;
+    }
+
+    void RetransmitServer::build_response(Connection& connection)
+    {
+        const RetransmitRequest& request = connection.request;
+        stats_.requests++;
+
+        std::vector<char>& out = connection.response;
+        out.resize(sizeof(RetransmitResponse));
+        uint32_t packet_count = 0;
+        const RetransmitStore::Range held = store_.for_each_packet(
+            request.first_sequence_number, request.last_sequence_number,
+            [&](const void* packet, size_t length)
+            {
+                const auto* bytes = static_cast<const char*>(packet);
+                out.insert(out.end(), bytes, bytes + length);
+                packet_count++;
+            });
+        if (held.empty() || request.first_sequence_number < held.first)
+        {
+            stats_.requests_too_old++;
+        }
+        stats_.packets_resent += packet_count;
+
+        RetransmitResponse response{};
+        response.first_available = held.first;
+        response.last_available = held.last;
+        response.packet_count = packet_count;
+        std::memcpy(out.data(), &response, sizeof(response));
+        connection.sent = 0;
+    }
+}
@@ -0,0 +1,162 @@
+#include "publisher/SnapshotPublisherThread.h"
+#include <iostream>
+#include <chrono>
+
+namespace mdfeed
+{
+    SnapshotPublisherThread::SnapshotPublisherThread(const PublisherConfig& config)
+        : config_(config)
+          , packet_(config.max_packet_size)
+          , running_(false)
+    {
+    }
+
+    SnapshotPublisherThread::~SnapshotPublisherThread()
+    {
+        stop();
+    }
+
+    bool SnapshotPublisherThread::start()
+    {
+        if (running_.load())
+        {
+            return true;
+        }
+
+        if (!multicast_publisher_.initialize(config_.snapshot_ip,
+                                             config_.snapshot_port,
+                                             config_.interface_ip))
+        {
+            std::cerr << "Failed to initialize snapshot publisher!" << std::endl;
+            return false;
+        }
+
+        running_.store(true);
+        stats_ = Stats{};
+
+        snapshot_thread_ = std::thread(&SnapshotPublisherThread::snapshot_loop, this);
+
+        std::cout << "SnapshotPublisherThread started - publishing to "
+            << config_.snapshot_ip << ":" << config_.snapshot_port << std::endl;
+        return true;
+    }
+
+    void SnapshotPublisherThread::stop()
+    {
+        if (!running_.load())
+        {
+            return;
+        }
+
+        running_.store(false);
+
+        if (snapshot_thread_.joinable())
+        {
+            snapshot_thread_.join();
+        }
+
+        multicast_publisher_.close();
+
+        std::cout << "SnapshotPublisherThread stopped. Snapshots sent: "
+            << stats_.snapshots_sent << ", Entries: " << stats_.entries_sent
+            << ", Packets: " << stats_.packets_sent << std::endl;
+    }
+
+    void SnapshotPublisherThread::update_images(BookImageSet images)
+    {
+        std::lock_guard<std::mutex> lock(images_mutex_);
+        images_ = std::move(images);
+    }
+
+    template <typename T>
+    void SnapshotPublisherThread::append(const T& message)
+    {
+        if (!packet_.fits(sizeof(T)))
+        {
+            flush();
+        }
+        if (!packet_.append(&message, sizeof(T)))
+        {
+            // larger than max_packet_size on its own
+            stats_.oversized_messages++;
+        }
+    }
+
+    void SnapshotPublisherThread::flush()
+    {
+        if (packet_.empty())
+        {
+            return;
+        }
+        if (multicast_publisher_.send(packet_.data(), packet_.finish()))
+        {
+            stats_.packets_sent++;
+        }
+        else
+        {
+            stats_.send_failures++;
+        }
+        packet_.reset();
+    }
+
+    void SnapshotPublisherThread::send_level(const BookImage& image, const SnapshotLevel& level, Side side)
+    {
+        SnapshotEntryMessage entry{};
+        message_utils::init_header(entry, MessageType::SNAPSHOT_ENTRY, image.sequence_number, image.instrument_id);
+        entry.price = level.price;
+        entry.quantity = level.quantity;
+        entry.side = side;
+        append(entry);
+    }
+
+    void SnapshotPublisherThread::send_image(const BookImage& image)
+    {
+        SnapshotBeginMessage begin{};
+        message_utils::init_header(begin, MessageType::SNAPSHOT_BEGIN, image.sequence_number, image.instrument_id);
+        begin.total_entries = static_cast<uint32_t>(image.depth->bids.size() + image.depth->asks.size());
+        append(begin);
+
+        for (const SnapshotLevel& level : image.depth->bids)
+        {
+            send_level(image, level, Side::BUY);
+        }
+        for (const SnapshotLevel& level : image.depth->asks)
+        {
+            send_level(image, level, Side::SELL);
+        }
+
+        SnapshotEndMessage end{};
+        message_utils::init_header(end, MessageType::SNAPSHOT_END, image.sequence_number, image.instrument_id);
+        end.checksum = image.depth->checksum;
+        append(end);
+
+        stats_.snapshots_sent++;
+        stats_.entries_sent += begin.total_entries;
+    }
+
+    void SnapshotPublisherThread::snapshot_loop()
+    {
+        auto next_cycle = std::chrono::steady_clock::now();
+        while (running_.load(std::memory_order_relaxed))
+        {
+            if (std::chrono::steady_clock::now() < next_cycle)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            next_cycle += config_.snapshot_interval;
+
+            BookImageSet images;
+            {
+                std::lock_guard<std::mutex> lock(images_mutex_);
+                images = images_;
+            }
+            for (const auto& [instrument_id, image] : images)
+            {
+                send_image(image);
+            }
+            flush();
+            stats_.cycles++;
+        }
+    }
+}
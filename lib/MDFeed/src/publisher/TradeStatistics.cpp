@@ -0,0 +1,71 @@
+#include "publisher/TradeStatistics.h"
+#include <algorithm>
+
+namespace mdfeed
+{
+    void Ohlcv::merge(const Ohlcv& later)
+    {
+        if (later.trade_count == 0)
+        {
+            return;
+        }
+        if (trade_count == 0)
+        {
+            *this = later;
+            return;
+        }
+        high = later.high > high ? later.high : high;
+        low = later.low < low ? later.low : low;
+        close = later.close;
+        volume += later.volume;
+        notional += later.notional;
+        trade_count += later.trade_count;
+    }
+
+    TradeStatistics::TradeStatistics(std::chrono::milliseconds bucket_width)
+        : bucket_width_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(bucket_width).count())
+    {
+        if (bucket_width_ns_ == 0)
+        {
+            bucket_width_ns_ = 1;
+        }
+    }
+
+    void TradeStatistics::on_trade(uint64_t price, uint64_t quantity, uint64_t timestamp_ns)
+    {
+        const uint64_t index = timestamp_ns / bucket_width_ns_;
+        Bucket& bucket = buckets_[index % WINDOW_BUCKETS];
+        if (bucket.index != index)
+        {
+            bucket.index = index;
+            bucket.stats = Ohlcv{};
+        }
+        bucket.stats.add(price, quantity);
+        session_.add(price, quantity);
+        current_bucket_ = index;
+    }
+
+    TradeSummary TradeStatistics::summary(uint64_t now_ns) const
+    {
+        TradeSummary result{session_, Ohlcv{},
+                            static_cast<uint32_t>(bucket_width_ns_ * WINDOW_BUCKETS / 1000000)};
+        if (session_.trade_count == 0)
+        {
+            return result;
+        }
+        // a clock read slightly behind the last trade still includes it
+        const uint64_t last = std::max(now_ns / bucket_width_ns_, current_bucket_);
+        // oldest bucket first so open/close come out in time order; a slot still
+        // holding a bucket from before the window does not match its index
+        const uint64_t first = last >= WINDOW_BUCKETS - 1 ? last - (WINDOW_BUCKETS - 1) : 0;
+        for (uint64_t index = first; index <= last; ++index)
+        {
+            const Bucket& bucket = buckets_[index % WINDOW_BUCKETS];
+            if (bucket.index == index)
+            {
+                result.window.merge(bucket.stats);
+            }
+        }
+        return result;
+    }
+}
@@ -0,0 +1,114 @@
+#include "receiver/InstrumentFilter.h"
+#include "messages/Messages.h"
+#include "utils/PacketFraming.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#endif
+
+namespace mdfeed
+{
+#ifdef __linux__
+    namespace
+    {
+        static_assert(sizeof(BpfInstruction) == sizeof(sock_filter));
+
+        // a UDP socket's filter sees the datagram from its UDP header
+        constexpr uint32_t UDP_HEADER_SIZE = 8;
+        constexpr uint32_t PAYLOAD = UDP_HEADER_SIZE;
+        constexpr uint32_t ACCEPT = 0xFFFFFFFF;
+        constexpr uint32_t DROP = 0;
+        // scratch memory slots for the current message's offset and the low byte of its length
+        constexpr uint32_t OFFSET_SLOT = 0;
+        constexpr uint32_t LENGTH_SLOT = 1;
+
+        // the most messages of the types the publisher sends that fit in one packet
+        constexpr size_t SMALLEST_MESSAGE = std::min({
+            sizeof(HeartbeatMessage), sizeof(PriceLevelUpdateMessage), sizeof(PriceLevelDeleteMessage),
+            sizeof(TradeMessage), sizeof(SnapshotBeginMessage), sizeof(SnapshotEntryMessage),
+            sizeof(SnapshotEndMessage), sizeof(BookClearMessage), sizeof(StatisticsMessage)
+        });
+        constexpr size_t MAX_MESSAGES = (MAX_PACKET_SIZE - sizeof(PacketHeader)) / SMALLEST_MESSAGE;
+        // filter length the kernel accepts
+        constexpr size_t MAX_INSTRUCTIONS = BPF_MAXINSNS;
+        // instructions per message besides one comparison per instrument
+        constexpr size_t STEP_INSTRUCTIONS = 12;
+
+        // the two low-order bytes of message_length; messages are never longer than a packet
+        constexpr uint32_t LENGTH_LOW = offsetof(MessageHeader, message_length)
+            + (std::endian::native == std::endian::little ? 0 : 3);
+        constexpr uint32_t LENGTH_HIGH = offsetof(MessageHeader, message_length)
+            + (std::endian::native == std::endian::little ? 1 : 2);
+
+        BpfInstruction statement(uint16_t code, uint32_t k)
+        {
+            return {code, 0, 0, k};
+        }
+
+        BpfInstruction jump(uint16_t code, uint32_t k, uint8_t jt, uint8_t jf)
+        {
+            return {code, jt, jf, k};
+        }
+    }
+
+    // Classic BPF has no loops, so the walk over a packet's messages is
+    // unrolled MAX_MESSAGES times. X holds the offset of the current message;
+    // a load past the end of the datagram ends the program and drops it,
+    // which is how a packet with no wanted message is rejected.
+    std::vector<BpfInstruction> compile_instrument_filter(std::span<const uint32_t> instrument_ids)
+    {
+        std::vector<uint32_t> ids(instrument_ids.begin(), instrument_ids.end());
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        // about 80 instruments fit; that also keeps every jump to its block's accept within 8 bits
+        const size_t length = 4 + MAX_MESSAGES * (ids.size() + STEP_INSTRUCTIONS) + 1;
+        if (ids.empty() || length > MAX_INSTRUCTIONS)
+        {
+            return {};
+        }
+
+        std::vector<BpfInstruction> program;
+        program.reserve(length);
+        program.push_back(statement(BPF_LD | BPF_B | BPF_ABS, PAYLOAD + offsetof(PacketHeader, format)));
+        program.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(PacketFormat::PLAIN), 1, 0));
+        program.push_back(statement(BPF_RET | BPF_K, ACCEPT));
+        program.push_back(statement(BPF_LDX | BPF_IMM, PAYLOAD + sizeof(PacketHeader)));
+
+        for (size_t message = 0; message < MAX_MESSAGES; ++message)
+        {
+            // word loads are big-endian, compare against the id as the host stored it
+            program.push_back(statement(BPF_LD | BPF_W | BPF_IND, offsetof(MessageHeader, instrument_id)));
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                const auto to_accept = static_cast<uint8_t>(ids.size() - 1 - i);
+                program.push_back(jump(BPF_JMP | BPF_JEQ | BPF_K, ntohl(ids[i]), to_accept,
+                                       i + 1 == ids.size() ? 1 : 0));
+            }
+            program.push_back(statement(BPF_RET | BPF_K, ACCEPT));
+
+            // X += message_length
+            program.push_back(statement(BPF_STX, OFFSET_SLOT));
+            program.push_back(statement(BPF_LD | BPF_B | BPF_IND, LENGTH_LOW));
+            program.push_back(statement(BPF_ST, LENGTH_SLOT));
+            program.push_back(statement(BPF_LD | BPF_B | BPF_IND, LENGTH_HIGH));
+            program.push_back(statement(BPF_ALU | BPF_LSH | BPF_K, 8));
+            program.push_back(statement(BPF_LDX | BPF_MEM, LENGTH_SLOT));
+            program.push_back(statement(BPF_ALU | BPF_OR | BPF_X, 0));
+            program.push_back(statement(BPF_LDX | BPF_MEM, OFFSET_SLOT));
+            program.push_back(statement(BPF_ALU | BPF_ADD | BPF_X, 0));
+            program.push_back(statement(BPF_MISC | BPF_TAX, 0));
+        }
+        program.push_back(statement(BPF_RET | BPF_K, DROP));
+        return program;
+    }
+#else
+    std::vector<BpfInstruction> compile_instrument_filter(std::span<const uint32_t>)
+    {
+        return {};
+    }
+#endif
+}
@@ -0,0 +1,204 @@
+#include "receiver/MessageJournal.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace mdfeed
+{
+    MessageJournal::MessageJournal(bool to_console, const std::string& file_path, size_t buffer_bytes,
+                                   std::chrono::milliseconds flush_interval)
+        : to_console_(to_console)
+          , file_path_(file_path)
+          , ring_(buffer_bytes)
+          , flush_interval_(flush_interval)
+    {
+        if (!file_path_.empty())
+        {
+            file_.open(file_path_, std::ios::app);
+        }
+    }
+
+    MessageJournal::~MessageJournal()
+    {
+        stop();
+    }
+
+    void MessageJournal::start()
+    {
+        if (running_.exchange(true))
+        {
+            return;
+        }
+        writer_thread_ = std::thread(&MessageJournal::writer_loop, this);
+    }
+
+    void MessageJournal::stop()
+    {
+        if (!running_.exchange(false))
+        {
+            return;
+        }
+        if (writer_thread_.joinable())
+        {
+            writer_thread_.join();
+        }
+        drain();
+        if (file_.is_open())
+        {
+            file_.flush();
+        }
+    }
+
+    void MessageJournal::record(const void* message, size_t length)
+    {
+        append(EntryKind::MESSAGE, message, length);
+    }
+
+    void MessageJournal::record_text(std::string_view text)
+    {
+        append(EntryKind::TEXT, text.data(), text.size());
+    }
+
+    void MessageJournal::append(EntryKind kind, const void* data, size_t length)
+    {
+        void* slot = ring_.claim(sizeof(EntryKind) + length);
+        if (!slot)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::memcpy(slot, &kind, sizeof(kind));
+        std::memcpy(static_cast<char*>(slot) + sizeof(kind), data, length);
+        ring_.commit(sizeof(kind) + length);
+    }
+
+    void MessageJournal::write_line(const std::string& line)
+    {
+        write(line + '\n');
+    }
+
+    void MessageJournal::writer_loop()
+    {
+        while (running_.load(std::memory_order_relaxed))
+        {
+            if (!drain())
+            {
+                std::this_thread::sleep_for(flush_interval_);
+            }
+        }
+    }
+
+    bool MessageJournal::drain()
+    {
+        batch_.clear();
+        while (const ByteRing::Record record = ring_.peek())
+        {
+            EntryKind kind;
+            std::memcpy(&kind, record.data, sizeof(kind));
+            const char* payload = static_cast<const char*>(record.data) + sizeof(kind);
+            const size_t length = record.length - sizeof(kind);
+            if (kind == EntryKind::MESSAGE)
+            {
+                // records are 8-byte aligned and so is the payload after the kind
+                batch_ += format_message(*reinterpret_cast<const MessageHeader*>(payload), payload);
+            }
+            else
+            {
+                batch_.append(payload, length);
+            }
+            batch_ += '\n';
+            ring_.release();
+        }
+        if (batch_.empty())
+        {
+            return false;
+        }
+        write(batch_);
+        return true;
+    }
+
+    void MessageJournal::write(const std::string& text)
+    {
+        std::lock_guard lock(output_mutex_);
+        if (to_console_)
+        {
+            std::cout << text << std::flush;
+        }
+        if (file_.is_open())
+        {
+            file_ << text;
+            file_.flush();
+        }
+    }
+
+    std::string MessageJournal::format_message(const MessageHeader& header, const void* data)
+    {
+        std::ostringstream oss;
+        oss << "[" << message_utils::format_timestamp(header.timestamp_ns) << "] ";
+
+        switch (static_cast<MessageType>(header.message_type))
+        {
+        case MessageType::HEARTBEAT:
+            {
+                const auto* msg = reinterpret_cast<const HeartbeatMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::PRICE_LEVEL_UPDATE:
+            {
+                const auto* msg = reinterpret_cast<const PriceLevelUpdateMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::PRICE_LEVEL_DELETE:
+            {
+                const auto* msg = reinterpret_cast<const PriceLevelDeleteMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::TRADE:
+            {
+                const auto* msg = reinterpret_cast<const TradeMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::SNAPSHOT_BEGIN:
+            {
+                const auto* msg = reinterpret_cast<const SnapshotBeginMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::SNAPSHOT_ENTRY:
+            {
+                const auto* msg = reinterpret_cast<const SnapshotEntryMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::SNAPSHOT_END:
+            {
+                const auto* msg = reinterpret_cast<const SnapshotEndMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::BOOK_CLEAR:
+            {
+                const auto* msg = reinterpret_cast<const BookClearMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        case MessageType::STATISTICS:
+            {
+                const auto* msg = reinterpret_cast<const StatisticsMessage*>(data);
+                oss << msg->toDebugString();
+                break;
+            }
+        default:
+            {
+                oss << "UNKNOWN_MESSAGE: " << header.toDebugString();
+                break;
+            }
+        }
+
+        return oss.str();
+    }
+}
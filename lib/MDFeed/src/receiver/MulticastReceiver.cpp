@@ -1,28 +1,44 @@
 #include "receiver/MulticastReceiver.h"
+#include "receiver/InstrumentFilter.h"
+#include "receiver/RetransmitClient.h"
+#include "utils/PacketFraming.h"
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
 #include <iostream>
-#include <fstream>
 #include <iomanip>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace mdfeed
 {
-    class MulticastSocket
+    class MulticastReceiveSocket
     {
     public:
-        MulticastSocket() : socket_fd_(-1)
+        MulticastReceiveSocket() : socket_fd_(-1)
         {
         }
 
-        ~MulticastSocket()
+        ~MulticastReceiveSocket()
         {
             close();
         }
 
         bool create_and_join(const std::string& multicast_ip, uint16_t port,
-                             const std::string& interface_ip, size_t buffer_size)
+                             const std::string& interface_ip, size_t buffer_size, bool non_blocking,
+                             bool kernel_timestamps = false)
         {
             socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
             if (socket_fd_ < 0)
@@ -73,19 +89,97 @@ namespace mdfeed
                 return false;
             }
 
+#ifdef SO_TIMESTAMPNS
+            // the kernel stamps each datagram as it arrives, receive_batch reads it back
+            int timestamps = 1;
+            timestamps_enabled_ = kernel_timestamps
+                && setsockopt(socket_fd_, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps)) == 0;
+#else
+            (void)kernel_timestamps;
+#endif
+
+            if (non_blocking && fcntl(socket_fd_, F_SETFL, fcntl(socket_fd_, F_GETFL, 0) | O_NONBLOCK) < 0)
+            {
+                close();
+                return false;
+            }
+
             return true;
         }
 
-        ssize_t receive_data(void* buffer, size_t buffer_size) const
+        // preallocates count datagram buffers of datagram_size bytes for receive_batch
+        void prepare_batch(size_t count, size_t datagram_size)
+        {
+            datagram_size_ = datagram_size;
+            buffers_.assign(count * datagram_size, 0);
+            lengths_.assign(count, 0);
+            truncated_.assign(count, false);
+            receive_times_.assign(count, 0);
+#ifdef __linux__
+            iovecs_.resize(count);
+            headers_.resize(count);
+            control_.assign(timestamps_enabled_ ? count * CONTROL_SIZE : 0, 0);
+            for (size_t i = 0; i < count; ++i)
+            {
+                iovecs_[i].iov_base = buffers_.data() + i * datagram_size;
+                iovecs_[i].iov_len = datagram_size;
+            }
+#endif
+        }
+
+        // Fills the prepared buffers with as many waiting datagrams as fit,
+        // blocking for the first one unless the socket is non-blocking.
+        // Returns how many arrived, 0 if none were waiting, or -1 on error.
+        int receive_batch()
         {
             if (socket_fd_ < 0)
             {
                 return -1;
             }
-
-            return recv(socket_fd_, buffer, buffer_size, 0);
+#ifdef __linux__
+            for (size_t i = 0; i < headers_.size(); ++i)
+            {
+                headers_[i] = mmsghdr{};
+                headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+                headers_[i].msg_hdr.msg_iovlen = 1;
+                if (timestamps_enabled_)
+                {
+                    headers_[i].msg_hdr.msg_control = control_.data() + i * CONTROL_SIZE;
+                    headers_[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+                }
+            }
+            const int received = recvmmsg(socket_fd_, headers_.data(), static_cast<unsigned int>(headers_.size()),
+                                          MSG_WAITFORONE, nullptr);
+            if (received < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+            }
+            for (int i = 0; i < received; ++i)
+            {
+                lengths_[i] = headers_[i].msg_len;
+                truncated_[i] = (headers_[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+                receive_times_[i] = timestamps_enabled_ ? kernel_time(headers_[i].msg_hdr) : 0;
+            }
+            return received;
+#else
+            const ssize_t received = recv(socket_fd_, buffers_.data(), datagram_size_, MSG_TRUNC);
+            if (received < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+            }
+            lengths_[0] = std::min(static_cast<size_t>(received), datagram_size_);
+            truncated_[0] = static_cast<size_t>(received) > datagram_size_;
+            receive_times_[0] = 0;
+            return 1;
+#endif
         }
 
+        [[nodiscard]] const char* datagram(size_t i) const { return buffers_.data() + i * datagram_size_; }
+        [[nodiscard]] size_t length(size_t i) const { return lengths_[i]; }
+        [[nodiscard]] bool truncated(size_t i) const { return truncated_[i]; }
+        // kernel arrival time in wall-clock nanoseconds, 0 when not available
+        [[nodiscard]] uint64_t receive_time(size_t i) const { return receive_times_[i]; }
+
         void close()
         {
             if (socket_fd_ >= 0)
@@ -96,32 +190,73 @@ namespace mdfeed
         }
 
         [[nodiscard]] bool is_valid() const { return socket_fd_ >= 0; }
+        [[nodiscard]] int fd() const { return socket_fd_; }
+
+        // datagrams the program rejects are dropped by the kernel before they are queued
+        bool attach_filter(const std::vector<BpfInstruction>& program)
+        {
+#ifdef __linux__
+            sock_fprog fprog{};
+            fprog.len = static_cast<unsigned short>(program.size());
+            fprog.filter = reinterpret_cast<sock_filter*>(const_cast<BpfInstruction*>(program.data()));
+            return socket_fd_ >= 0 && !program.empty()
+                && setsockopt(socket_fd_, SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) == 0;
+#else
+            (void)program;
+            return false;
+#endif
+        }
 
     private:
+#ifdef __linux__
+        static constexpr size_t CONTROL_SIZE = CMSG_SPACE(sizeof(timespec));
+
+        static uint64_t kernel_time(msghdr& header)
+        {
+            for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg))
+            {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+                {
+                    timespec ts{};
+                    std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+                }
+            }
+            return 0;
+        }
+#endif
+
         int socket_fd_;
+        bool timestamps_enabled_ = false;
+        size_t datagram_size_ = 0;
+        std::vector<char> buffers_;
+        std::vector<size_t> lengths_;
+        std::vector<bool> truncated_;
+        std::vector<uint64_t> receive_times_;
+#ifdef __linux__
+        std::vector<iovec> iovecs_;
+        std::vector<mmsghdr> headers_;
+        std::vector<char> control_;
+#endif
     };
 
-    MulticastReceiver::MulticastReceiver()
-        : socket_(std::make_unique<MulticastSocket>())
+    MulticastReceiverBase::MulticastReceiverBase()
+        : socket_(std::make_unique<MulticastReceiveSocket>())
           , running_(false)
           , last_sequence_number_(0)
     {
         stats_.start_time = std::chrono::steady_clock::now();
         last_stats_time_ = stats_.start_time;
+        // calibrate now rather than on the receive thread's first timestamp
+        common::TscClock::instance();
     }
 
-    MulticastReceiver::MulticastReceiver(const ReceiverConfig& config)
-        : MulticastReceiver()
-    {
-        initialize(config);
-    }
-
-    MulticastReceiver::~MulticastReceiver()
+    MulticastReceiverBase::~MulticastReceiverBase()
     {
         stop();
     }
 
-    bool MulticastReceiver::initialize(const ReceiverConfig& config)
+    bool MulticastReceiverBase::initialize(const ReceiverConfig& config)
     {
         if (running_.load())
         {
@@ -129,22 +264,65 @@ namespace mdfeed
         }
 
         config_ = config;
-        if (config_.enable_logging && !config_.log_file_path.empty())
+        instruments_ = config_.instruments;
+        std::sort(instruments_.begin(), instruments_.end());
+        if (!instruments_.empty())
         {
-            log_file_ = std::make_unique<std::ofstream>(config_.log_file_path, std::ios::app);
-            if (!log_file_->is_open())
+            // the sequence numbers of filtered packets are missing by design
+            config_.validate_sequence_numbers = false;
+        }
+        journal_.reset();
+        if (config_.enable_logging)
+        {
+            journal_ = std::make_shared<MessageJournal>(config_.log_to_console, config_.log_file_path,
+                                                        config_.journal_buffer_bytes, config_.journal_flush_interval);
+            if (!journal_->is_open())
             {
                 std::cerr << "Failed to open log file: " << config_.log_file_path << std::endl;
                 return false;
             }
         }
 
-        socket_ = std::make_unique<MulticastSocket>();
-        return socket_->create_and_join(config_.multicast_ip, config_.multicast_port,
-                                        config_.interface_ip, config_.receive_buffer_size);
+        retransmit_.reset();
+        if (config_.validate_sequence_numbers && config_.retransmit_port != 0)
+        {
+            retransmit_ = std::make_unique<RetransmitClient>(config_.retransmit_ip, config_.retransmit_port,
+                                                             config_.retransmit_timeout);
+        }
+
+        snapshot_socket_.reset();
+        if (config_.validate_sequence_numbers && config_.snapshot_port != 0)
+        {
+            snapshot_socket_ = std::make_unique<MulticastReceiveSocket>();
+            if (!snapshot_socket_->create_and_join(config_.snapshot_ip, config_.snapshot_port,
+                                                   config_.interface_ip, config_.receive_buffer_size, true))
+            {
+                std::cerr << "Failed to join snapshot group " << config_.snapshot_ip << ":"
+                    << config_.snapshot_port << ", recovering from retransmission only" << std::endl;
+                snapshot_socket_.reset();
+            }
+        }
+        recovery_queue_ = RecoveryQueue(retransmit_ || snapshot_socket_ ? config_.recovery_queue_bytes : 0);
+        state_.store(FeedState::LIVE);
+
+        socket_ = std::make_unique<MulticastReceiveSocket>();
+        batch_socket_ = socket_.get();
+        if (!socket_->create_and_join(config_.multicast_ip, config_.multicast_port,
+                                      config_.interface_ip, config_.receive_buffer_size, config_.busy_poll,
+                                      config_.kernel_timestamps))
+        {
+            return false;
+        }
+        // datagrams that arrived before the filter, or when it cannot be attached, are filtered in process_message
+        if (!instruments_.empty() && !socket_->attach_filter(compile_instrument_filter(instruments_)))
+        {
+            std::cerr << "Could not attach the instrument filter to " << config_.multicast_ip << ":"
+                << config_.multicast_port << ", filtering after receive" << std::endl;
+        }
+        return true;
     }
 
-    bool MulticastReceiver::start()
+    bool MulticastReceiverBase::begin_start()
     {
         if (running_.load() || !socket_ || !socket_->is_valid())
         {
@@ -152,7 +330,10 @@ namespace mdfeed
         }
 
         running_.store(true);
-        receiver_thread_ = std::thread(&MulticastReceiver::receiver_loop, this);
+        if (journal_)
+        {
+            journal_->start();
+        }
         stats_thread_ = std::thread([this]()
         {
             while (running_.load())
@@ -168,7 +349,7 @@ namespace mdfeed
         return true;
     }
 
-    void MulticastReceiver::stop()
+    void MulticastReceiverBase::stop()
     {
         if (!running_.load())
         {
@@ -192,50 +373,110 @@ namespace mdfeed
             socket_->close();
         }
 
-        if (log_file_)
+        if (snapshot_socket_)
         {
-            log_file_->close();
+            snapshot_socket_->close();
         }
+
+        if (journal_)
+        {
+            journal_->stop();
+        }
+    }
+
+    int MulticastReceiverBase::socket_fd() const
+    {
+        return socket_ ? socket_->fd() : -1;
+    }
+
+    bool MulticastReceiverBase::pin_current_thread(int cpu)
+    {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
     }
 
-    void MulticastReceiver::receiver_loop()
+    void MulticastReceiverBase::begin_receiving()
     {
-        constexpr size_t BUFFER_SIZE = 65536;
-        const auto buffer = std::make_unique<char[]>(BUFFER_SIZE);
+        if (config_.receiver_cpu >= 0 && !pin_current_thread(config_.receiver_cpu))
+        {
+            log_message("Could not pin the receiver thread to CPU " + std::to_string(config_.receiver_cpu));
+        }
+
+        // a publisher never sends more than MAX_PACKET_SIZE, larger datagrams are reported truncated
+        constexpr size_t DATAGRAM_SIZE = 2048;
+        socket_->prepare_batch(std::max<size_t>(config_.receive_batch_size, 1), DATAGRAM_SIZE);
+        if (snapshot_socket_)
+        {
+            snapshot_socket_->prepare_batch(std::max<size_t>(config_.receive_batch_size, 1), DATAGRAM_SIZE);
+        }
 
         log_message("MulticastReceiver started - listening on " +
             config_.multicast_ip + ":" + std::to_string(config_.multicast_port));
+    }
+
+    int MulticastReceiverBase::receive_batch()
+    {
+        batch_socket_ = socket_.get();
+        return socket_->receive_batch();
+    }
 
-        while (running_.load())
+    int MulticastReceiverBase::receive_snapshot_batch()
+    {
+        if (!snapshot_socket_)
         {
-            ssize_t bytes_received = socket_->receive_data(buffer.get(), BUFFER_SIZE);
+            return -1;
+        }
+        batch_socket_ = snapshot_socket_.get();
+        return snapshot_socket_->receive_batch();
+    }
 
-            if (bytes_received > 0)
-            {
-                process_message(buffer.get(), static_cast<size_t>(bytes_received));
-                stats_.total_messages_received++;
-                stats_.total_bytes_received += bytes_received;
-            }
-            else if (bytes_received < 0)
-            {
-                if (running_.load())
-                {
-                    log_message("Error receiving data from multicast socket");
-                }
-                break;
-            }
+    bool MulticastReceiverBase::wait_for_datagrams(std::chrono::milliseconds timeout)
+    {
+        if (config_.busy_poll)
+        {
+            return true;
         }
+        pollfd fds[3] = {
+            {socket_->fd(), POLLIN, 0}, {snapshot_socket_ ? snapshot_socket_->fd() : -1, POLLIN, 0},
+            {retransmit_ ? retransmit_->fd() : -1, retransmit_ ? retransmit_->events() : short{0}, 0}
+        };
+        return poll(fds, 3, static_cast<int>(timeout.count())) > 0 && (fds[0].revents & POLLIN) != 0;
+    }
+
+    const char* MulticastReceiverBase::datagram(size_t i) const
+    {
+        return batch_socket_->datagram(i);
+    }
 
-        log_message("MulticastReceiver stopped");
+    size_t MulticastReceiverBase::datagram_length(size_t i) const
+    {
+        return batch_socket_->length(i);
+    }
+
+    bool MulticastReceiverBase::datagram_truncated(size_t i) const
+    {
+        return batch_socket_->truncated(i);
+    }
+
+    uint64_t MulticastReceiverBase::datagram_receive_time(size_t i) const
+    {
+        return batch_socket_->receive_time(i);
     }
 
-    void MulticastReceiver::process_message(const void* data, const size_t length)
+    bool MulticastReceiverBase::check_message(const void* data, const size_t length)
     {
         if (length < sizeof(MessageHeader))
         {
             stats_.invalid_messages++;
             log_message("Received invalid message: too small (" + std::to_string(length) + " bytes)");
-            return;
+            return false;
         }
 
         const auto* header = static_cast<const MessageHeader*>(data);
@@ -245,125 +486,331 @@ namespace mdfeed
             log_message("Message length mismatch: header says " +
                 std::to_string(header->message_length) +
                 ", received " + std::to_string(length));
-            return;
+            return false;
         }
-        if (config_.validate_sequence_numbers && last_sequence_number_ > 0)
+        return true;
+    }
+
+    MulticastReceiverBase::Gap MulticastReceiverBase::check_sequence(const MessageHeader& header)
+    {
+        const bool repeated = message_utils::repeats_sequence(header.message_type);
+        const uint64_t expected = repeated ? last_sequence_number_ : last_sequence_number_ + 1;
+        if (!config_.validate_sequence_numbers || last_sequence_number_ == 0 || header.sequence_number == expected)
         {
-            if (header->sequence_number != last_sequence_number_ + 1)
-            {
-                uint64_t gap = header->sequence_number - last_sequence_number_ - 1;
-                stats_.sequence_gaps += gap;
-                log_message("Sequence gap detected: expected " +
-                    std::to_string(last_sequence_number_ + 1) +
-                    ", got " + std::to_string(header->sequence_number) +
-                    " (gap: " + std::to_string(gap) + ")");
-            }
+            return {};
         }
-        last_sequence_number_ = header->sequence_number;
-        std::string debug_str = format_message_debug(*header, data);
-        log_message(debug_str);
-        if (message_handler_)
+
+        uint64_t gap = header.sequence_number - expected;
+        stats_.sequence_gaps += gap;
+        log_message("Sequence gap detected: expected " +
+            std::to_string(expected) +
+            ", got " + std::to_string(header.sequence_number) +
+            " (gap: " + std::to_string(gap) + ")");
+        if (header.sequence_number < expected)
         {
-            message_handler_(*header, data, length);
+            return {};
         }
+        // a heartbeat or statistics message repeats the last number, so the message it carries is missing too
+        return {last_sequence_number_ + 1, repeated ? header.sequence_number : header.sequence_number - 1};
     }
 
-    std::string MulticastReceiver::format_message_debug(const MessageHeader& header, const void* data)
+    void MulticastReceiverBase::accept_sequence(const MessageHeader& header)
     {
-        std::ostringstream oss;
-        oss << "[" << message_utils::format_timestamp(header.timestamp_ns) << "] ";
+        if (header.message_type == static_cast<uint16_t>(MessageType::HEARTBEAT))
+        {
+            stats_.heartbeats_received++;
+        }
+        last_sequence_number_ = header.sequence_number;
+    }
 
-        switch (static_cast<MessageType>(header.message_type))
+    void MulticastReceiverBase::service_gap_fill(const std::function<void(const void*, size_t)>& on_packet)
+    {
+        if (retransmit_->busy())
         {
-        case MessageType::HEARTBEAT:
+            if (release_queue_ || !queue_contiguous_)
             {
-                const auto* msg = reinterpret_cast<const HeartbeatMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                // recovery moved on without it, to a snapshot or a second gap
+                retransmit_->cancel();
+                return;
             }
-        case MessageType::PRICE_LEVEL_UPDATE:
-            {
-                const auto* msg = reinterpret_cast<const PriceLevelUpdateMessage*>(data);
-                oss << msg->toDebugString();
-                break;
-            }
-        case MessageType::PRICE_LEVEL_DELETE:
+        }
+        else
+        {
+            if (!retransmit_due())
             {
-                const auto* msg = reinterpret_cast<const PriceLevelDeleteMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                return;
             }
-        case MessageType::TRADE:
+            fill_gap_ = recovery_gap_;
+            fill_recovered_ = 0;
+            if (!retransmit_->start(fill_gap_.first, fill_gap_.last))
             {
-                const auto* msg = reinterpret_cast<const TradeMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                finish_gap(fill_gap_, 0, false);
+                return;
             }
-        case MessageType::SNAPSHOT_BEGIN:
+        }
+
+        const RetransmitClient::Status status = retransmit_->poll(on_packet);
+        if (status == RetransmitClient::Status::PENDING)
+        {
+            return;
+        }
+        finish_gap(fill_gap_, fill_recovered_, status == RetransmitClient::Status::DONE);
+        update_gap(last_sequence_number_ < fill_gap_.last ? Gap{last_sequence_number_ + 1, fill_gap_.last} : Gap{});
+    }
+
+    void MulticastReceiverBase::finish_gap(const Gap& gap, uint64_t recovered, bool answered)
+    {
+        stats_.messages_recovered += recovered;
+        if (!answered || recovered != gap.last - gap.first + 1)
+        {
+            stats_.recovery_failures++;
+            log_message("Gap fill incomplete: recovered " + std::to_string(recovered) + " of " +
+                std::to_string(gap.last - gap.first + 1) + " messages");
+        }
+        else
+        {
+            log_message("Gap filled: " + std::to_string(recovered) + " messages recovered");
+        }
+    }
+
+    bool MulticastReceiverBase::can_recover() const
+    {
+        return feed_state() == FeedState::LIVE && (retransmit_ || snapshot_socket_);
+    }
+
+    void MulticastReceiverBase::begin_recovery(const Gap& missing)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        recovery_queue_.clear();
+        recovery_gap_ = missing;
+        queue_contiguous_ = true;
+        required_sequence_ = missing.last;
+        queued_last_ = missing.last;
+        release_queue_ = false;
+        snapshot_cycle_started_ = false;
+        snapshot_image_open_ = false;
+        recovery_deadline_ = now + config_.recovery_timeout;
+        // the first gap fill goes out on the next service_recovery
+        next_retransmit_ = now;
+        state_.store(FeedState::RECOVERING, std::memory_order_relaxed);
+        stats_.recoveries++;
+        log_message("Recovering messages " + std::to_string(missing.first) + "-" + std::to_string(missing.last) +
+            ", holding back later messages");
+    }
+
+    bool MulticastReceiverBase::hold_message(const MessageHeader& header, const void* data, size_t length)
+    {
+        const FeedState state = feed_state();
+        if (release_queue_ || state == FeedState::LIVE || (state == FeedState::STALE && !snapshot_socket_))
+        {
+            return false;
+        }
+
+        const bool repeated = message_utils::repeats_sequence(header.message_type);
+        const uint64_t expected = repeated ? queued_last_ : queued_last_ + 1;
+        if (header.sequence_number < expected)
+        {
+            // a duplicate, or late and inside the range being recovered
+            return true;
+        }
+        if (header.sequence_number > expected)
+        {
+            if (!snapshot_socket_)
             {
-                const auto* msg = reinterpret_cast<const SnapshotBeginMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                // only the first gap is retried, so a second one is beyond repair;
+                // check_sequence counts it once the queue has been delivered
+                give_up_recovery("another gap while recovering");
+                return false;
             }
-        case MessageType::SNAPSHOT_ENTRY:
+            stats_.sequence_gaps += header.sequence_number - expected;
+            log_message("Sequence gap while recovering: expected " + std::to_string(expected) + ", got " +
+                std::to_string(header.sequence_number) + ", waiting for a snapshot");
+            queue_contiguous_ = false;
+            required_sequence_ = repeated ? header.sequence_number : header.sequence_number - 1;
+            snapshot_cycle_started_ = false;
+        }
+        if (!recovery_queue_.push(data, length))
+        {
+            if (!snapshot_socket_)
             {
-                const auto* msg = reinterpret_cast<const SnapshotEntryMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                give_up_recovery("recovery queue full");
+                return false;
             }
-        case MessageType::SNAPSHOT_END:
+            // start over from the next snapshot cycle, this message included in what it must cover
+            log_message("Recovery queue full, dropped " + std::to_string(recovery_queue_.size()) +
+                " messages, waiting for a snapshot");
+            recovery_queue_.clear();
+            queue_contiguous_ = false;
+            required_sequence_ = header.sequence_number;
+            queued_last_ = header.sequence_number;
+            snapshot_cycle_started_ = false;
+            mark_stale();
+            return true;
+        }
+        queued_last_ = header.sequence_number;
+        return true;
+    }
+
+    bool MulticastReceiverBase::retransmit_due()
+    {
+        if (!retransmit_ || release_queue_ || !queue_contiguous_ || feed_state() != FeedState::RECOVERING)
+        {
+            return false;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_retransmit_)
+        {
+            return false;
+        }
+        next_retransmit_ = now + RETRANSMIT_RETRY_INTERVAL;
+        return true;
+    }
+
+    void MulticastReceiverBase::update_gap(const Gap& missing)
+    {
+        if (!missing.empty())
+        {
+            recovery_gap_ = missing;
+            return;
+        }
+        log_message("Gap recovered by retransmission");
+        release(FeedState::LIVE);
+    }
+
+    void MulticastReceiverBase::check_recovery_timeout()
+    {
+        if (release_queue_ || feed_state() != FeedState::RECOVERING
+            || std::chrono::steady_clock::now() < recovery_deadline_)
+        {
+            return;
+        }
+        if (!snapshot_socket_)
+        {
+            give_up_recovery("timed out");
+            return;
+        }
+        // keep holding messages back, a snapshot cycle can still recover the feed
+        log_message("Gap not recovered in time, waiting for a snapshot");
+        mark_stale();
+    }
+
+    bool MulticastReceiverBase::awaiting_snapshot() const
+    {
+        return snapshot_socket_ && !release_queue_ && feed_state() != FeedState::LIVE;
+    }
+
+    MulticastReceiverBase::SnapshotStep MulticastReceiverBase::track_snapshot(const MessageHeader& header)
+    {
+        if (header.sequence_number < required_sequence_)
+        {
+            return SnapshotStep::SKIP;
+        }
+        switch (static_cast<MessageType>(header.message_type))
+        {
+        case MessageType::SNAPSHOT_BEGIN:
+            // back at the instrument the run began with, so every book has been sent since
+            if (snapshot_cycle_started_ && !snapshot_image_open_ && header.instrument_id == snapshot_first_instrument_)
             {
-                const auto* msg = reinterpret_cast<const SnapshotEndMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                stats_.snapshot_recoveries++;
+                log_message("Recovered from snapshot cycle at or after " + std::to_string(required_sequence_));
+                release(FeedState::LIVE);
+                return SnapshotStep::COMPLETE;
             }
-        case MessageType::BOOK_CLEAR:
+            // an image without its end lost a datagram, so the run starts over here
+            if (!snapshot_cycle_started_ || snapshot_image_open_)
             {
-                const auto* msg = reinterpret_cast<const BookClearMessage*>(data);
-                oss << msg->toDebugString();
-                break;
+                snapshot_cycle_started_ = true;
+                snapshot_first_instrument_ = header.instrument_id;
             }
+            snapshot_image_open_ = true;
+            return SnapshotStep::DELIVER;
+        case MessageType::SNAPSHOT_END:
+            snapshot_image_open_ = false;
+            break;
         default:
-            {
-                oss << "UNKNOWN_MESSAGE: " << header.toDebugString();
-                break;
-            }
+            break;
         }
-
-        return oss.str();
+        return snapshot_cycle_started_ ? SnapshotStep::DELIVER : SnapshotStep::SKIP;
     }
 
-    void MulticastReceiver::log_message(const std::string& message) const
+    void MulticastReceiverBase::finish_release()
     {
-        if (!config_.enable_logging)
+        stats_.messages_replayed += recovery_queue_.size();
+        recovery_queue_.clear();
+        last_sequence_number_ = std::max(last_sequence_number_, queued_last_);
+        release_queue_ = false;
+        state_.store(release_state_, std::memory_order_relaxed);
+        if (retransmit_)
         {
-            return;
+            // a snapshot or giving up ended recovery with a gap fill still in flight
+            retransmit_->cancel();
         }
+    }
+
+    void MulticastReceiverBase::release(FeedState next)
+    {
+        release_queue_ = true;
+        release_state_ = next;
+    }
 
-        if (config_.log_to_console)
+    void MulticastReceiverBase::give_up_recovery(const char* reason)
+    {
+        log_message(std::string("Gap recovery abandoned (") + reason + "), delivering " +
+            std::to_string(recovery_queue_.size()) + " held messages as STALE");
+        stats_.stale_transitions++;
+        release(FeedState::STALE);
+    }
+
+    void MulticastReceiverBase::mark_stale()
+    {
+        if (feed_state() != FeedState::STALE)
         {
-            std::cout << message << std::endl;
+            stats_.stale_transitions++;
+            state_.store(FeedState::STALE, std::memory_order_relaxed);
         }
+    }
 
-        if (log_file_ && log_file_->is_open())
+    void MulticastReceiverBase::log_message(const std::string& message) const
+    {
+        if (journal_)
         {
-            *log_file_ << message << std::endl;
-            log_file_->flush();
+            journal_->record_text(message);
         }
     }
 
-    void MulticastReceiver::print_stats()
+    void MulticastReceiverBase::print_stats()
     {
         auto now = std::chrono::steady_clock::now();
+        last_stats_time_ = now;
+        if (!journal_)
+        {
+            return;
+        }
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - stats_.start_time);
 
         std::ostringstream oss;
         oss << "\n=== RECEIVER STATISTICS ===\n"
+            << "Group: " << config_.multicast_ip << ":" << config_.multicast_port << "\n"
             << "Runtime: " << elapsed.count() << "s\n"
             << "Total Messages: " << stats_.total_messages_received << "\n"
+            << "Total Packets: " << stats_.total_packets_received << "\n"
             << "Total Bytes: " << stats_.total_bytes_received << "\n"
             << "Sequence Gaps: " << stats_.sequence_gaps << "\n"
-            << "Invalid Messages: " << stats_.invalid_messages << "\n";
+            << "Recovered: " << stats_.messages_recovered << " (" << stats_.recovery_failures
+            << " incomplete fills)\n"
+            << "Recoveries: " << stats_.recoveries << " (" << stats_.snapshot_recoveries << " from snapshots, "
+            << stats_.messages_replayed << " messages replayed, " << stats_.stale_transitions << " stale)\n"
+            << "Heartbeats: " << stats_.heartbeats_received << "\n"
+            << "Invalid Messages: " << stats_.invalid_messages << "\n"
+            << "Filtered Messages: " << stats_.filtered_messages << "\n"
+            << "Receive batches: " << stats_.receive_batches << " (avg " << std::fixed << std::setprecision(2)
+            << stats_.average_batch_size() << ", max " << stats_.max_batch_size << ")\n"
+            << "Log entries dropped: " << journal_->dropped_entries() << "\n";
+        if (wire_to_user_.count() > 0)
+        {
+            oss << "Publish->wire: " << format_latency(publish_to_wire_.summary()) << "\n"
+                << "Wire->user: " << format_latency(wire_to_user_.summary()) << "\n";
+        }
 
         if (elapsed.count() > 0)
         {
@@ -371,16 +818,37 @@ namespace mdfeed
                 << "MB/sec: " << std::fixed << std::setprecision(2)
                 << (stats_.total_bytes_received / (1024.0 * 1024.0) / elapsed.count()) << "\n";
         }
-        oss << "==========================\n";
-        log_message(oss.str());
-        last_stats_time_ = now;
+        oss << "==========================";
+        // the stats thread is not the journal's producer
+        journal_->write_line(oss.str());
+    }
+
+    std::string MulticastReceiverBase::format_latency(const LatencySummary& latency)
+    {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1)
+            << "p50 " << latency.p50_ns / 1000.0 << "us, p99 " << latency.p99_ns / 1000.0
+            << "us, p99.9 " << latency.p999_ns / 1000.0 << "us, max " << latency.max_ns / 1000.0
+            << "us (" << latency.count << " samples)";
+        return oss.str();
+    }
+
+    MulticastReceiverBase::Stats MulticastReceiverBase::get_stats() const
+    {
+        Stats stats = stats_;
+        stats.log_entries_dropped = journal_ ? journal_->dropped_entries() : 0;
+        stats.publish_to_wire = publish_to_wire_.summary();
+        stats.wire_to_user = wire_to_user_.summary();
+        return stats;
     }
 
-    void MulticastReceiver::reset_stats()
+    void MulticastReceiverBase::reset_stats()
     {
         stats_ = Stats{};
         stats_.start_time = std::chrono::steady_clock::now();
         last_stats_time_ = stats_.start_time;
         last_sequence_number_ = 0;
+        publish_to_wire_.reset();
+        wire_to_user_.reset();
     }
 }
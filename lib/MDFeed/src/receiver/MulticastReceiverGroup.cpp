@@ -0,0 +1,45 @@
+#include "receiver/MulticastReceiverGroup.h"
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace mdfeed
+{
+    namespace
+    {
+        constexpr int MAX_EVENTS = 64;
+    }
+
+    ReadySet::ReadySet()
+        : epoll_fd_(epoll_create1(EPOLL_CLOEXEC))
+          , events_(std::make_unique<epoll_event[]>(MAX_EVENTS))
+    {
+        ready_.reserve(MAX_EVENTS);
+    }
+
+    ReadySet::~ReadySet()
+    {
+        if (epoll_fd_ >= 0)
+        {
+            ::close(epoll_fd_);
+        }
+    }
+
+    bool ReadySet::add(int fd, uint32_t index)
+    {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = index;
+        return epoll_fd_ >= 0 && fd >= 0 && epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    std::span<const uint32_t> ReadySet::wait(std::chrono::milliseconds timeout)
+    {
+        ready_.clear();
+        const int count = epoll_wait(epoll_fd_, events_.get(), MAX_EVENTS, static_cast<int>(timeout.count()));
+        for (int i = 0; i < count; ++i)
+        {
+            ready_.push_back(events_[i].data.u32);
+        }
+        return ready_;
+    }
+}
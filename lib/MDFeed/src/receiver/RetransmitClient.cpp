@@ -0,0 +1,248 @@
+#include "receiver/RetransmitClient.h"
+#include "utils/PacketFraming.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace mdfeed
+{
+    RetransmitClient::RetransmitClient(std::string ip, uint16_t port, std::chrono::milliseconds timeout)
+        : ip_(std::move(ip))
+          , port_(port)
+          , timeout_(timeout)
+          , socket_fd_(-1)
+          , packet_(MAX_PACKET_SIZE)
+    {
+    }
+
+    RetransmitClient::~RetransmitClient()
+    {
+        close();
+    }
+
+    bool RetransmitClient::connect()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_connect_)
+        {
+            return false;
+        }
+        next_connect_ = now + reconnect_interval;
+
+        socket_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (socket_fd_ < 0)
+        {
+            return false;
+        }
+        int no_delay = 1;
+        setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port_);
+        if (inet_aton(ip_.c_str(), &address.sin_addr) == 0)
+        {
+            close();
+            return false;
+        }
+        // usually still in progress, poll finishes it
+        if (::connect(socket_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+        {
+            connected_ = true;
+        }
+        else if (errno != EINPROGRESS)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void RetransmitClient::close()
+    {
+        if (socket_fd_ >= 0)
+        {
+            ::close(socket_fd_);
+            socket_fd_ = -1;
+        }
+        connected_ = false;
+        state_ = State::IDLE;
+    }
+
+    void RetransmitClient::cancel()
+    {
+        if (busy())
+        {
+            // the rest of the reply would be out of step with the next request
+            close();
+            next_connect_ = {};
+        }
+    }
+
+    short RetransmitClient::events() const
+    {
+        switch (state_)
+        {
+        case State::CONNECTING:
+        case State::SENDING:
+            return POLLOUT;
+        case State::REPLY:
+        case State::PACKETS:
+            return POLLIN;
+        default:
+            return 0;
+        }
+    }
+
+    bool RetransmitClient::start(uint64_t first, uint64_t last)
+    {
+        if (busy() || (socket_fd_ < 0 && !connect()))
+        {
+            return false;
+        }
+        request_ = RetransmitRequest{first, last};
+        sent_ = 0;
+        received_ = 0;
+        deadline_ = std::chrono::steady_clock::now() + timeout_;
+        state_ = connected_ ? State::SENDING : State::CONNECTING;
+        return true;
+    }
+
+    RetransmitClient::Status RetransmitClient::fail()
+    {
+        close();
+        return Status::FAILED;
+    }
+
+    RetransmitClient::Status RetransmitClient::wait(std::chrono::steady_clock::time_point now)
+    {
+        return now < deadline_ ? Status::PENDING : fail();
+    }
+
+    size_t RetransmitClient::expected_bytes() const
+    {
+        if (state_ == State::REPLY)
+        {
+            return sizeof(RetransmitResponse);
+        }
+        if (received_ < sizeof(PacketHeader))
+        {
+            return sizeof(PacketHeader);
+        }
+        const auto* header = reinterpret_cast<const PacketHeader*>(packet_.data());
+        return header->packet_length < sizeof(PacketHeader) || header->packet_length > packet_.size()
+                   ? 0
+                   : header->packet_length;
+    }
+
+    RetransmitClient::Status RetransmitClient::poll(const PacketHandler& handler)
+    {
+        if (!busy())
+        {
+            return Status::FAILED;
+        }
+        const auto now = std::chrono::steady_clock::now();
+
+        if (state_ == State::CONNECTING)
+        {
+            pollfd writable{socket_fd_, POLLOUT, 0};
+            if (::poll(&writable, 1, 0) == 0)
+            {
+                return wait(now);
+            }
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (getsockopt(socket_fd_, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)
+            {
+                return fail();
+            }
+            connected_ = true;
+            state_ = State::SENDING;
+        }
+
+        if (state_ == State::SENDING)
+        {
+            const ssize_t result = send(socket_fd_, reinterpret_cast<const char*>(&request_) + sent_,
+                                        sizeof(request_) - sent_, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (result < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK ? wait(now) : fail();
+            }
+            sent_ += static_cast<size_t>(result);
+            deadline_ = now + timeout_;
+            if (sent_ < sizeof(request_))
+            {
+                return Status::PENDING;
+            }
+            state_ = State::REPLY;
+        }
+
+        while (true)
+        {
+            if (state_ == State::PACKETS && packets_left_ == 0)
+            {
+                state_ = State::IDLE;
+                return Status::DONE;
+            }
+            const size_t wanted = expected_bytes();
+            if (wanted == 0)
+            {
+                // the stream is out of step with the reply, start over on a new connection
+                return fail();
+            }
+            char* buffer = state_ == State::REPLY ? reinterpret_cast<char*>(&response_) : packet_.data();
+            if (received_ == wanted)
+            {
+                if (state_ == State::REPLY)
+                {
+                    packets_left_ = response_.packet_count;
+                    state_ = State::PACKETS;
+                }
+                else
+                {
+                    handler(buffer, wanted);
+                    packets_left_--;
+                }
+                received_ = 0;
+                continue;
+            }
+            const ssize_t result = recv(socket_fd_, buffer + received_, wanted - received_, MSG_DONTWAIT);
+            if (result == 0)
+            {
+                return fail();
+            }
+            if (result < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK ? wait(now) : fail();
+            }
+            received_ += static_cast<size_t>(result);
+            deadline_ = now + timeout_;
+        }
+    }
+
+    bool RetransmitClient::request(uint64_t first, uint64_t last, const PacketHandler& handler,
+                                   RetransmitResponse* response)
+    {
+        if (!start(first, last))
+        {
+            return false;
+        }
+        Status status;
+        while ((status = poll(handler)) == Status::PENDING)
+        {
+            pollfd ready{socket_fd_, events(), 0};
+            ::poll(&ready, 1, static_cast<int>(timeout_.count()));
+        }
+        if (status == Status::DONE && response)
+        {
+            *response = response_;
+        }
+        return status == Status::DONE;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct SweepCost {
+    uint32_t filledQuantity;
+    uint32_t levelsConsumed;
+    long worstPrice;
+    double vwap;
+};
+
+// Cumulative quantity and notional for one side of the book, in book order
+// (best price first). Entries are rebuilt lazily: a level change only drops
+// the entries from that price outward, the levels in front of it stay cached.
+class DepthPrefix {
+private:
+    bool ascending_;
+    bool complete_;
+    std::vector<long> prices_;
+    std::vector<uint64_t> cumQuantity_;
+    std::vector<long> cumNotional_;
+
+public:
+    explicit DepthPrefix(bool ascending);
+
+    void Invalidate(long price);
+
+    template<typename LimitMap>
+    void Refresh(const LimitMap &limits) {
+        if (complete_) {
+            return;
+        }
+        auto it = prices_.empty() ? limits.begin() : limits.upper_bound(prices_.back());
+        for (; it != limits.end(); ++it) {
+            const uint32_t quantity = it->second->GetOrderQuantity();
+            if (quantity == 0) {
+                continue;
+            }
+            const uint64_t prevQuantity = cumQuantity_.empty() ? 0 : cumQuantity_.back();
+            const long prevNotional = cumNotional_.empty() ? 0 : cumNotional_.back();
+            prices_.push_back(it->first);
+            cumQuantity_.push_back(prevQuantity + quantity);
+            cumNotional_.push_back(prevNotional + it->first * static_cast<long>(quantity));
+        }
+        complete_ = true;
+    }
+
+    [[nodiscard]] SweepCost Sweep(uint32_t quantity) const;
+};
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <limits>
 #include <list>
+#include <type_traits>
 #include <unordered_map>
 #include <map>
+#include <vector>
 
+#include "core/DepthPrefix.h"
 #include "orders/Order.h"
 #include "entries/OrderBookEntry.h"
 #include "securities/Security.h"
 #include "publisher/MDAdapter.h"
+#include "utils/BookChecksum.h"
 
 class OrderBookSpread {
 private:
@@ -29,12 +34,53 @@ public:
     }
 };
 
+// Best bid and ask, kept up to date by every mutation so reading it is a plain
+// copy. An empty side is marked by a sentinel price with zero quantity/count.
+struct TopOfBook {
+    static constexpr long NO_BID = std::numeric_limits<long>::min();
+    static constexpr long NO_ASK = std::numeric_limits<long>::max();
+
+    long bidPrice = NO_BID;
+    long askPrice = NO_ASK;
+    uint32_t bidQuantity = 0;
+    uint32_t askQuantity = 0;
+    uint32_t bidOrderCount = 0;
+    uint32_t askOrderCount = 0;
+
+    [[nodiscard]] bool HasBid() const noexcept {
+        return bidPrice != NO_BID;
+    }
+
+    [[nodiscard]] bool HasAsk() const noexcept {
+        return askPrice != NO_ASK;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<TopOfBook>);
+
+struct LevelChange {
+    long price;
+    uint32_t quantity;
+    bool isBid;
+};
+
 template<typename MarketDataPublisher>
 class OrderBook {
 private:
     Security instrument_;
     long matchedQuantity_;
+    uint64_t nextTradeId_ = 1;
     mdfeed::MDAdapter<MarketDataPublisher> md_adapter_;
+    mdfeed::BookChecksum checksum_;
+    TopOfBook top_;
+    DepthPrefix bidDepth_{false};
+    DepthPrefix askDepth_{true};
+
+    // levels touched since the last DrainLevelChanges, price -> latest quantity.
+    // only tracked once a consumer has drained at least once.
+    bool trackLevelChanges_ = false;
+    std::unordered_map<long, uint32_t> dirtyBids_;
+    std::unordered_map<long, uint32_t> dirtyAsks_;
 
     // sorted maps
     // limits could also be implemented as an array with pointers to the best bid and ask limit.
@@ -54,6 +100,13 @@ private:
 
     bool RemoveOrder(long orderId, const std::shared_ptr<OrderBookEntry> &obe);
 
+    // every change to a level's total quantity goes through here so the
+    // checksum and the market data feed always agree with the book.
+    void OnLevelChange(long price, uint32_t oldQuantity, uint32_t newQuantity, bool isBid);
+
+    // called at the end of every public mutation, once the level maps are final.
+    void UpdateTopOfBook();
+
 public:
     OrderBook(const Security &instrument, mdfeed::MDAdapter<MarketDataPublisher> mdAdapter);
 
@@ -63,6 +116,10 @@ public:
 
     OrderBookSpread GetSpread();
 
+    TopOfBook GetTopOfBook() const {
+        return top_;
+    }
+
     boost::optional<std::shared_ptr<Limit>> GetBestBidLimit();
 
     boost::optional<std::shared_ptr<Limit>> GetBestAskLimit();
@@ -89,12 +146,26 @@ public:
 
     std::map<long, uint32_t> GetAskQuantities();
 
+    // levels changed since the previous call; the first call returns the whole book
+    std::vector<LevelChange> DrainLevelChanges();
+
+    // what a market order of this size would pay right now, without placing it
+    SweepCost GetCostToFill(uint32_t quantity, bool isBuy);
+
     std::list<OrderStruct> GetOrders();
 
     long GetOrdersMatched() const {
         return matchedQuantity_;
     }
 
+    mdfeed::TradeSummary GetTradeSummary() const {
+        return md_adapter_.statistics().summary(mdfeed::message_utils::get_timestamp_ns());
+    }
+
+    uint32_t GetChecksum() const {
+        return checksum_.value();
+    }
+
     template<typename LimitMap>
     uint32_t TryMatch(Order &incomingOrder, long price, LimitMap &opposingLimits);
 };
@@ -1,3 +1,4 @@
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/operators.h>
@@ -59,6 +60,36 @@ PYBIND11_MODULE(_orderbook, m)
             return py::none();
         }, "Get the spread (None if no spread available)");
 
+    py::class_<mdfeed::Ohlcv>(m, "Ohlcv")
+        .def_readonly("open", &mdfeed::Ohlcv::open)
+        .def_readonly("high", &mdfeed::Ohlcv::high)
+        .def_readonly("low", &mdfeed::Ohlcv::low)
+        .def_readonly("close", &mdfeed::Ohlcv::close)
+        .def_readonly("volume", &mdfeed::Ohlcv::volume)
+        .def_readonly("trade_count", &mdfeed::Ohlcv::trade_count)
+        .def("vwap", &mdfeed::Ohlcv::vwap, "Get the volume weighted average price");
+
+    py::class_<mdfeed::TradeSummary>(m, "TradeSummary")
+        .def_readonly("session", &mdfeed::TradeSummary::session)
+        .def_readonly("window", &mdfeed::TradeSummary::window)
+        .def_readonly("window_ms", &mdfeed::TradeSummary::window_ms);
+
+    py::class_<TopOfBook>(m, "TopOfBook")
+        .def_readonly("bid_price", &TopOfBook::bidPrice)
+        .def_readonly("ask_price", &TopOfBook::askPrice)
+        .def_readonly("bid_quantity", &TopOfBook::bidQuantity)
+        .def_readonly("ask_quantity", &TopOfBook::askQuantity)
+        .def_readonly("bid_order_count", &TopOfBook::bidOrderCount)
+        .def_readonly("ask_order_count", &TopOfBook::askOrderCount)
+        .def("has_bid", &TopOfBook::HasBid, "Check if there is a bid")
+        .def("has_ask", &TopOfBook::HasAsk, "Check if there is an ask");
+
+    py::class_<SweepCost>(m, "SweepCost")
+        .def_readonly("filled_quantity", &SweepCost::filledQuantity)
+        .def_readonly("levels_consumed", &SweepCost::levelsConsumed)
+        .def_readonly("worst_price", &SweepCost::worstPrice)
+        .def_readonly("vwap", &SweepCost::vwap);
+
     py::class_<PyOrderBook>(m, "OrderBook")
         .def(py::init([](const Security& security)
         {
@@ -74,6 +105,9 @@ PYBIND11_MODULE(_orderbook, m)
 
         .def("get_spread", &PyOrderBook::GetSpread, "Get bid-ask spread")
 
+        .def("get_top_of_book", &PyOrderBook::GetTopOfBook,
+             "Get best bid and ask prices, quantities and order counts")
+
         .def("get_best_bid_price", [](PyOrderBook& self) -> py::object
         {
             auto price = self.GetBestBidPrice();
@@ -119,8 +153,33 @@ PYBIND11_MODULE(_orderbook, m)
         .def("get_ask_quantities", &PyOrderBook::GetAskQuantities,
              "Get ask quantities by price level")
 
+        .def("drain_level_changes", [](PyOrderBook& self)
+        {
+            const auto changes = self.DrainLevelChanges();
+            py::array_t<int64_t> result({static_cast<py::ssize_t>(changes.size()), py::ssize_t{3}});
+            auto rows = result.mutable_unchecked<2>();
+            for (py::ssize_t i = 0; i < rows.shape(0); ++i)
+            {
+                const auto& change = changes[i];
+                rows(i, 0) = change.price;
+                rows(i, 1) = static_cast<int64_t>(change.isBid ? mdfeed::Side::BUY : mdfeed::Side::SELL);
+                rows(i, 2) = change.quantity;
+            }
+            return result;
+        }, "Get (price, side, quantity) rows for levels changed since the previous call; "
+           "side is 1 for bids and 2 for asks, quantity 0 means the level was removed. "
+           "The first call returns the whole book")
+
+        .def("get_cost_to_fill", &PyOrderBook::GetCostToFill,
+             "Get the VWAP, worst price and levels a market order of this size would consume",
+             py::arg("quantity"), py::arg("is_buy"))
+
         .def("get_orders_matched", &PyOrderBook::GetOrdersMatched,
-             "Get total quantity of orders matched");
+             "Get total quantity of orders matched")
+        .def("get_trade_summary", &PyOrderBook::GetTradeSummary,
+             "Get session and rolling-window OHLCV statistics")
+        .def("get_checksum", &PyOrderBook::GetChecksum,
+             "Get the order-independent checksum of the price levels");
 
     m.def("create_order", [](const std::string& username, int security_id,
                              long price, uint32_t quantity, bool is_buy)
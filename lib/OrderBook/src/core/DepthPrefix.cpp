@@ -0,0 +1,42 @@
+#include "core/DepthPrefix.h"
+
+#include <algorithm>
+#include <functional>
+
+DepthPrefix::DepthPrefix(bool ascending) {
+    ascending_ = ascending;
+    complete_ = false;
+}
+
+void DepthPrefix::Invalidate(long price) {
+    complete_ = false;
+    if (prices_.empty()) {
+        return;
+    }
+    auto it = ascending_
+              ? std::lower_bound(prices_.begin(), prices_.end(), price)
+              : std::lower_bound(prices_.begin(), prices_.end(), price, std::greater<>());
+    const auto depth = static_cast<size_t>(it - prices_.begin());
+    prices_.resize(depth);
+    cumQuantity_.resize(depth);
+    cumNotional_.resize(depth);
+}
+
+SweepCost DepthPrefix::Sweep(uint32_t quantity) const {
+    if (prices_.empty() || quantity == 0) {
+        return {0, 0, 0, 0.0};
+    }
+    auto it = std::lower_bound(cumQuantity_.begin(), cumQuantity_.end(), static_cast<uint64_t>(quantity));
+    if (it == cumQuantity_.end()) {
+        // not enough resting quantity, the sweep takes the whole side
+        const auto filled = static_cast<uint32_t>(cumQuantity_.back());
+        return {filled, static_cast<uint32_t>(prices_.size()), prices_.back(),
+                static_cast<double>(cumNotional_.back()) / filled};
+    }
+    const auto level = static_cast<size_t>(it - cumQuantity_.begin());
+    const uint64_t prevQuantity = level == 0 ? 0 : cumQuantity_[level - 1];
+    const long prevNotional = level == 0 ? 0 : cumNotional_[level - 1];
+    const long notional = prevNotional + prices_[level] * static_cast<long>(quantity - prevQuantity);
+    return {quantity, static_cast<uint32_t>(level + 1), prices_[level],
+            static_cast<double>(notional) / quantity};
+}
@@ -30,15 +30,7 @@ bool OrderBook<MarketDataPublisher>::ContainsOrder(long orderId) {
 
 template<typename MarketDataPublisher>
 OrderBookSpread OrderBook<MarketDataPublisher>::GetSpread() {
-    boost::optional<long> bestAsk = boost::none;
-    boost::optional<long> bestBid = boost::none;
-    if (!askLimits_.empty() && askLimits_.begin()->second->head_ != nullptr) {
-        bestAsk = askLimits_.begin()->first;
-    }
-    if (!bidLimits_.empty() && bidLimits_.begin()->second->head_ != nullptr) {
-        bestBid = bidLimits_.begin()->first;
-    }
-    return {bestBid, bestAsk};
+    return {GetBestBidPrice(), GetBestAskPrice()};
 }
 
 template<typename MarketDataPublisher>
@@ -59,18 +51,18 @@ boost::optional<std::shared_ptr<Limit>> OrderBook<MarketDataPublisher>::GetBestA
 
 template<typename MarketDataPublisher>
 boost::optional<long> OrderBook<MarketDataPublisher>::GetBestBidPrice() {
-    if (bidLimits_.empty()) {
+    if (!top_.HasBid()) {
         return boost::none;
     }
-    return bidLimits_.begin()->first;
+    return top_.bidPrice;
 }
 
 template<typename MarketDataPublisher>
 boost::optional<long> OrderBook<MarketDataPublisher>::GetBestAskPrice() {
-    if (askLimits_.empty()) {
+    if (!top_.HasAsk()) {
         return boost::none;
     }
-    return askLimits_.begin()->first;
+    return top_.askPrice;
 }
 
 template<typename MarketDataPublisher>
@@ -78,6 +70,7 @@ void OrderBook<MarketDataPublisher>::AddOrder(const Order &order) {
     order.IsBuy()
     ? AddOrder(order, order.Price(), bidLimits_, orders_)
     : AddOrder(order, order.Price(), askLimits_, orders_);
+    UpdateTopOfBook();
 }
 
 template<typename MarketDataPublisher>
@@ -86,6 +79,7 @@ void OrderBook<MarketDataPublisher>::AmendOrder(const long orderId, const Order
     order.IsBuy()
     ? AddOrder(order, order.Price(), bidLimits_, orders_)
     : AddOrder(order, order.Price(), askLimits_, orders_);
+    UpdateTopOfBook();
 }
 
 template<typename MarketDataPublisher>
@@ -101,6 +95,7 @@ void OrderBook<MarketDataPublisher>::RemoveOrder(const long orderId) {
                 askLimits_.erase(price);
             }
         }
+        UpdateTopOfBook();
     } else {
         throw std::invalid_argument("order id not found");
     }
@@ -162,6 +157,42 @@ std::map<long, uint32_t> OrderBook<MarketDataPublisher>::GetAskQuantities() {
     return limitQuantities;
 }
 
+template<typename MarketDataPublisher>
+std::vector<LevelChange> OrderBook<MarketDataPublisher>::DrainLevelChanges() {
+    std::vector<LevelChange> changes;
+    if (!trackLevelChanges_) {
+        trackLevelChanges_ = true;
+        changes.reserve(bidLimits_.size() + askLimits_.size());
+        for (const auto &[price, quantity]: GetBidQuantities()) {
+            changes.push_back({price, quantity, true});
+        }
+        for (const auto &[price, quantity]: GetAskQuantities()) {
+            changes.push_back({price, quantity, false});
+        }
+        return changes;
+    }
+    changes.reserve(dirtyBids_.size() + dirtyAsks_.size());
+    for (const auto &[price, quantity]: dirtyBids_) {
+        changes.push_back({price, quantity, true});
+    }
+    for (const auto &[price, quantity]: dirtyAsks_) {
+        changes.push_back({price, quantity, false});
+    }
+    dirtyBids_.clear();
+    dirtyAsks_.clear();
+    return changes;
+}
+
+template<typename MarketDataPublisher>
+SweepCost OrderBook<MarketDataPublisher>::GetCostToFill(uint32_t quantity, bool isBuy) {
+    if (isBuy) {
+        askDepth_.Refresh(askLimits_);
+        return askDepth_.Sweep(quantity);
+    }
+    bidDepth_.Refresh(bidLimits_);
+    return bidDepth_.Sweep(quantity);
+}
+
 template<typename MarketDataPublisher>
 std::list<OrderStruct> OrderBook<MarketDataPublisher>::GetOrders() {
     std::list<OrderStruct> orders;
@@ -196,8 +227,10 @@ void OrderBook<MarketDataPublisher>::AddOrder(Order order, long price,
         limitLevels[price] = limit;
     }
     auto entry = std::make_shared<OrderBookEntry>(limit, order);
+    const uint32_t oldQuantity = limit->GetOrderQuantity();
     limit->AddOrder(entry);
     internalOrderBook[order.OrderId()] = entry;
+    OnLevelChange(price, oldQuantity, limit->GetOrderQuantity(), order.IsBuy());
 }
 
 template<typename MarketDataPublisher>
@@ -208,8 +241,11 @@ bool OrderBook<MarketDataPublisher>::RemoveOrder(long orderId, const std::shared
         return false;
     }
 
+    const bool isBid = obe->CurrentOrder().IsBuy();
+    const uint32_t oldQuantity = limit->GetOrderQuantity();
     if (limit->GetOrderCount() == 1) {
         orders_.erase(orderId);
+        OnLevelChange(limit->Price(), oldQuantity, 0, isBid);
         return true;
     }
 
@@ -227,9 +263,48 @@ bool OrderBook<MarketDataPublisher>::RemoveOrder(long orderId, const std::shared
 
     limit->RemoveOrder(obe->CurrentOrder().OrderId(), obe->CurrentOrder().CurrentQuantity());
     orders_.erase(orderId);
+    OnLevelChange(limit->Price(), oldQuantity, limit->GetOrderQuantity(), isBid);
     return false;
 }
 
+template<typename MarketDataPublisher>
+void OrderBook<MarketDataPublisher>::OnLevelChange(long price, uint32_t oldQuantity, uint32_t newQuantity,
+                                                   bool isBid) {
+    if (oldQuantity == newQuantity) {
+        return;
+    }
+    checksum_.update(isBid ? mdfeed::Side::BUY : mdfeed::Side::SELL, price, oldQuantity, newQuantity);
+    isBid ? bidDepth_.Invalidate(price) : askDepth_.Invalidate(price);
+    if (trackLevelChanges_) {
+        (isBid ? dirtyBids_ : dirtyAsks_)[price] = newQuantity;
+    }
+    md_adapter_.notify_price_level_change(price, newQuantity, oldQuantity, isBid);
+}
+
+template<typename MarketDataPublisher>
+void OrderBook<MarketDataPublisher>::UpdateTopOfBook() {
+    if (bidLimits_.empty()) {
+        top_.bidPrice = TopOfBook::NO_BID;
+        top_.bidQuantity = 0;
+        top_.bidOrderCount = 0;
+    } else {
+        const auto &[price, limit] = *bidLimits_.begin();
+        top_.bidPrice = price;
+        top_.bidQuantity = limit->GetOrderQuantity();
+        top_.bidOrderCount = limit->GetOrderCount();
+    }
+    if (askLimits_.empty()) {
+        top_.askPrice = TopOfBook::NO_ASK;
+        top_.askQuantity = 0;
+        top_.askOrderCount = 0;
+    } else {
+        const auto &[price, limit] = *askLimits_.begin();
+        top_.askPrice = price;
+        top_.askQuantity = limit->GetOrderQuantity();
+        top_.askOrderCount = limit->GetOrderCount();
+    }
+}
+
 template<typename MarketDataPublisher>
 void OrderBook<MarketDataPublisher>::PlaceMarketBuyOrder(uint32_t quantity) {
     if (askLimits_.empty()) {
@@ -244,6 +319,7 @@ void OrderBook<MarketDataPublisher>::PlaceMarketBuyOrder(uint32_t quantity) {
     } else {
         spdlog::info("Market buy order completely filled");
     }
+    UpdateTopOfBook();
 }
 
 template<typename MarketDataPublisher>
@@ -260,6 +336,7 @@ void OrderBook<MarketDataPublisher>::PlaceMarketSellOrder(uint32_t quantity) {
     } else {
         spdlog::info("Market sell order completely filled");
     }
+    UpdateTopOfBook();
 }
 
 template<typename MarketDataPublisher>
@@ -269,6 +346,7 @@ uint32_t OrderBook<MarketDataPublisher>::TryMatch(Order &incomingOrder, long pri
     auto opposingIter = opposingLimits.begin();
     uint32_t remainingQty = incomingOrder.CurrentQuantity();
     bool erasedLimit = false;
+    const uint64_t matchTime = mdfeed::message_utils::get_timestamp_ns();
     while (opposingIter != opposingLimits.end() && remainingQty > 0) {
         long opposingPrice = opposingIter->first;
 
@@ -284,10 +362,12 @@ uint32_t OrderBook<MarketDataPublisher>::TryMatch(Order &incomingOrder, long pri
             const uint32_t restingQty = restingOrder.CurrentQuantity();
             const uint32_t matchedQty = std::min(restingQty, remainingQty);
 
+            const uint32_t levelQty = limit->GetOrderQuantity();
             opposingOrderPtr->DecreaseQuantity(matchedQty);
             limit->DecreaseQuantity(matchedQty);
-            md_adapter_.notify_price_level_change(opposingPrice, restingQty - matchedQty, restingQty,
-                                                  !isBuy); // TODO: This should happen within the limit
+            OnLevelChange(opposingPrice, levelQty, limit->GetOrderQuantity(),
+                          !isBuy); // TODO: This should happen within the limit
+            md_adapter_.notify_trade(nextTradeId_++, opposingPrice, matchedQty, isBuy, matchTime);
 
             spdlog::debug("{} order {} {}filled @ {} pence", isBuy ? "buy" : "sell", incomingOrder.OrderId(),
                           matchedQty < remainingQty ? "partially " : "", opposingPrice);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/TscClock.h"
 #include <chrono>
 #include <iomanip>
 #include <sstream>
@@ -175,10 +176,7 @@ namespace orderentry {
     namespace message_utils {
         inline uint64_t get_timestamp_ns()
         {
-            return std::chrono::duration_cast<std::chrono::nanoseconds>(
-                           std::chrono::high_resolution_clock::now()
-                                   .time_since_epoch())
-                    .count();
+            return common::TscClock::now_ns();
         }
 
         template<typename T> void init_header(T& message, MessageType type,
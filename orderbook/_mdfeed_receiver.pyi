@@ -4,7 +4,7 @@ Python bindings for MDFeed MulticastReceiver library
 from __future__ import annotations
 import datetime
 import typing
-__all__ = ['BookClearMessage', 'HeartbeatMessage', 'MDMessageType', 'MDSide', 'MessageHeader', 'MulticastReceiver', 'PriceLevelDeleteMessage', 'PriceLevelUpdateMessage', 'ReceiverConfig', 'ReceiverStats', 'SnapshotBeginMessage', 'SnapshotEndMessage', 'SnapshotEntryMessage', 'TradeMessage', 'UpdateAction', 'cast_md_message', 'format_md_timestamp', 'get_md_timestamp_ns', 'md_message_type_to_string']
+__all__ = ['BookClearMessage', 'FeedState', 'HeartbeatMessage', 'LatencySummary', 'MDMessageType', 'MDSide', 'MessageHeader', 'MulticastReceiver', 'PriceLevelDeleteMessage', 'PriceLevelUpdateMessage', 'ReceiverConfig', 'ReceiverStats', 'SnapshotBeginMessage', 'SnapshotEndMessage', 'SnapshotEntryMessage', 'StatisticsMessage', 'TradeMessage', 'UpdateAction', 'cast_md_message', 'format_md_timestamp', 'get_md_timestamp_ns', 'md_message_type_to_string']
 class BookClearMessage:
     def to_debug_string(self) -> str:
         ...
@@ -14,12 +14,71 @@ class BookClearMessage:
     @property
     def reason_code(self) -> int:
         ...
+class FeedState:
+    """
+    Members:
+    
+      LIVE
+    
+      RECOVERING
+    
+      STALE
+    """
+    LIVE: typing.ClassVar[FeedState]  # value = <FeedState.LIVE: 0>
+    RECOVERING: typing.ClassVar[FeedState]  # value = <FeedState.RECOVERING: 1>
+    STALE: typing.ClassVar[FeedState]  # value = <FeedState.STALE: 2>
+    __members__: typing.ClassVar[dict[str, FeedState]]  # value = {'LIVE': <FeedState.LIVE: 0>, 'RECOVERING': <FeedState.RECOVERING: 1>, 'STALE': <FeedState.STALE: 2>}
+    def __eq__(self, other: typing.Any) -> bool:
+        ...
+    def __getstate__(self) -> int:
+        ...
+    def __hash__(self) -> int:
+        ...
+    def __index__(self) -> int:
+        ...
+    def __init__(self, value: int) -> None:
+        ...
+    def __int__(self) -> int:
+        ...
+    def __ne__(self, other: typing.Any) -> bool:
+        ...
+    def __repr__(self) -> str:
+        ...
+    def __setstate__(self, state: int) -> None:
+        ...
+    def __str__(self) -> str:
+        ...
+    @property
+    def name(self) -> str:
+        ...
+    @property
+    def value(self) -> int:
+        ...
 class HeartbeatMessage:
     def to_debug_string(self) -> str:
         ...
     @property
+    def checksum(self) -> int:
+        ...
+    @property
     def header(self) -> MessageHeader:
         ...
+class LatencySummary:
+    @property
+    def count(self) -> int:
+        ...
+    @property
+    def max_ns(self) -> int:
+        ...
+    @property
+    def p50_ns(self) -> int:
+        ...
+    @property
+    def p999_ns(self) -> int:
+        ...
+    @property
+    def p99_ns(self) -> int:
+        ...
 class MDMessageType:
     """
     Members:
@@ -39,6 +98,8 @@ class MDMessageType:
       SNAPSHOT_END
     
       BOOK_CLEAR
+    
+      STATISTICS
     """
     BOOK_CLEAR: typing.ClassVar[MDMessageType]  # value = <MDMessageType.BOOK_CLEAR: 8>
     HEARTBEAT: typing.ClassVar[MDMessageType]  # value = <MDMessageType.HEARTBEAT: 1>
@@ -47,8 +108,9 @@ class MDMessageType:
     SNAPSHOT_BEGIN: typing.ClassVar[MDMessageType]  # value = <MDMessageType.SNAPSHOT_BEGIN: 5>
     SNAPSHOT_END: typing.ClassVar[MDMessageType]  # value = <MDMessageType.SNAPSHOT_END: 7>
     SNAPSHOT_ENTRY: typing.ClassVar[MDMessageType]  # value = <MDMessageType.SNAPSHOT_ENTRY: 6>
+    STATISTICS: typing.ClassVar[MDMessageType]  # value = <MDMessageType.STATISTICS: 9>
     TRADE: typing.ClassVar[MDMessageType]  # value = <MDMessageType.TRADE: 4>
-    __members__: typing.ClassVar[dict[str, MDMessageType]]  # value = {'HEARTBEAT': <MDMessageType.HEARTBEAT: 1>, 'PRICE_LEVEL_UPDATE': <MDMessageType.PRICE_LEVEL_UPDATE: 2>, 'PRICE_LEVEL_DELETE': <MDMessageType.PRICE_LEVEL_DELETE: 3>, 'TRADE': <MDMessageType.TRADE: 4>, 'SNAPSHOT_BEGIN': <MDMessageType.SNAPSHOT_BEGIN: 5>, 'SNAPSHOT_ENTRY': <MDMessageType.SNAPSHOT_ENTRY: 6>, 'SNAPSHOT_END': <MDMessageType.SNAPSHOT_END: 7>, 'BOOK_CLEAR': <MDMessageType.BOOK_CLEAR: 8>}
+    __members__: typing.ClassVar[dict[str, MDMessageType]]  # value = {'HEARTBEAT': <MDMessageType.HEARTBEAT: 1>, 'PRICE_LEVEL_UPDATE': <MDMessageType.PRICE_LEVEL_UPDATE: 2>, 'PRICE_LEVEL_DELETE': <MDMessageType.PRICE_LEVEL_DELETE: 3>, 'TRADE': <MDMessageType.TRADE: 4>, 'SNAPSHOT_BEGIN': <MDMessageType.SNAPSHOT_BEGIN: 5>, 'SNAPSHOT_ENTRY': <MDMessageType.SNAPSHOT_ENTRY: 6>, 'SNAPSHOT_END': <MDMessageType.SNAPSHOT_END: 7>, 'BOOK_CLEAR': <MDMessageType.BOOK_CLEAR: 8>, 'STATISTICS': <MDMessageType.STATISTICS: 9>}
     def __eq__(self, other: typing.Any) -> bool:
         ...
     def __getstate__(self) -> int:
@@ -137,6 +199,10 @@ class MulticastReceiver:
     @typing.overload
     def __init__(self, arg0: ReceiverConfig) -> None:
         ...
+    def feed_state(self) -> FeedState:
+        """
+        LIVE, RECOVERING or STALE
+        """
     def get_stats(self) -> ReceiverStats:
         """
         Get receiver statistics
@@ -196,25 +262,76 @@ class PriceLevelUpdateMessage:
     def side(self) -> MDSide:
         ...
 class ReceiverConfig:
+    busy_poll: bool
     enable_logging: bool
+    instruments: list[int]
     interface_ip: str
+    journal_buffer_bytes: int
+    journal_flush_interval: datetime.timedelta
+    kernel_timestamps: bool
     log_file_path: str
     log_to_console: bool
     multicast_ip: str
     multicast_port: int
+    receive_batch_size: int
     receive_buffer_size: int
+    recovery_queue_bytes: int
+    recovery_timeout: datetime.timedelta
+    retransmit_ip: str
+    retransmit_port: int
+    retransmit_timeout: datetime.timedelta
+    snapshot_ip: str
+    snapshot_port: int
     stats_interval: datetime.timedelta
     validate_sequence_numbers: bool
     def __init__(self) -> None:
         ...
 class ReceiverStats:
+    def average_batch_size(self) -> float:
+        ...
+    @property
+    def filtered_messages(self) -> int:
+        ...
+    @property
+    def heartbeats_received(self) -> int:
+        ...
     @property
     def invalid_messages(self) -> int:
         ...
     @property
+    def log_entries_dropped(self) -> int:
+        ...
+    @property
+    def max_batch_size(self) -> int:
+        ...
+    @property
+    def messages_recovered(self) -> int:
+        ...
+    @property
+    def messages_replayed(self) -> int:
+        ...
+    @property
+    def publish_to_wire(self) -> LatencySummary:
+        ...
+    @property
+    def recoveries(self) -> int:
+        ...
+    @property
+    def recovery_failures(self) -> int:
+        ...
+    @property
+    def receive_batches(self) -> int:
+        ...
+    @property
     def sequence_gaps(self) -> int:
         ...
     @property
+    def snapshot_recoveries(self) -> int:
+        ...
+    @property
+    def stale_transitions(self) -> int:
+        ...
+    @property
     def start_time(self) -> datetime.timedelta:
         ...
     @property
@@ -223,6 +340,12 @@ class ReceiverStats:
     @property
     def total_messages_received(self) -> int:
         ...
+    @property
+    def total_packets_received(self) -> int:
+        ...
+    @property
+    def wire_to_user(self) -> LatencySummary:
+        ...
 class SnapshotBeginMessage:
     def to_debug_string(self) -> str:
         ...
@@ -256,6 +379,57 @@ class SnapshotEntryMessage:
     @property
     def side(self) -> MDSide:
         ...
+class StatisticsMessage:
+    def to_debug_string(self) -> str:
+        ...
+    @property
+    def header(self) -> MessageHeader:
+        ...
+    @property
+    def session_close(self) -> int:
+        ...
+    @property
+    def session_high(self) -> int:
+        ...
+    @property
+    def session_low(self) -> int:
+        ...
+    @property
+    def session_open(self) -> int:
+        ...
+    @property
+    def session_trade_count(self) -> int:
+        ...
+    @property
+    def session_volume(self) -> int:
+        ...
+    @property
+    def session_vwap(self) -> int:
+        ...
+    @property
+    def window_close(self) -> int:
+        ...
+    @property
+    def window_high(self) -> int:
+        ...
+    @property
+    def window_low(self) -> int:
+        ...
+    @property
+    def window_ms(self) -> int:
+        ...
+    @property
+    def window_open(self) -> int:
+        ...
+    @property
+    def window_trade_count(self) -> int:
+        ...
+    @property
+    def window_volume(self) -> int:
+        ...
+    @property
+    def window_vwap(self) -> int:
+        ...
 class TradeMessage:
     def to_debug_string(self) -> str:
         ...
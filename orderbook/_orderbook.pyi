@@ -2,8 +2,32 @@
 Python bindings for C++ OrderBook library
 """
 from __future__ import annotations
+import numpy
 import typing
-__all__ = ['Order', 'OrderBook', 'OrderBookSpread', 'OrderCore', 'Security', 'create_order']
+__all__ = ['Ohlcv', 'Order', 'OrderBook', 'OrderBookSpread', 'OrderCore', 'Security', 'SweepCost', 'TopOfBook', 'TradeSummary', 'create_order']
+class Ohlcv:
+    def vwap(self) -> int:
+        """
+        Get the volume weighted average price
+        """
+    @property
+    def close(self) -> int:
+        ...
+    @property
+    def high(self) -> int:
+        ...
+    @property
+    def low(self) -> int:
+        ...
+    @property
+    def open(self) -> int:
+        ...
+    @property
+    def trade_count(self) -> int:
+        ...
+    @property
+    def volume(self) -> int:
+        ...
 class Order:
     def __init__(self, order_core: OrderCore, price: int, quantity: int, is_buy: bool) -> None:
         """
@@ -58,6 +82,10 @@ class OrderBook:
         """
         Get total number of orders
         """
+    def drain_level_changes(self) -> numpy.ndarray:
+        """
+        Get (price, side, quantity) rows for levels changed since the previous call; side is 1 for bids and 2 for asks, quantity 0 means the level was removed. The first call returns the whole book
+        """
     def get_ask_quantities(self) -> dict[int, int]:
         """
         Get ask quantities by price level
@@ -74,6 +102,14 @@ class OrderBook:
         """
         Get bid quantities by price level
         """
+    def get_checksum(self) -> int:
+        """
+        Get the order-independent checksum of the price levels
+        """
+    def get_cost_to_fill(self, quantity: int, is_buy: bool) -> SweepCost:
+        """
+        Get the VWAP, worst price and levels a market order of this size would consume
+        """
     def get_orders_matched(self) -> int:
         """
         Get total quantity of orders matched
@@ -82,6 +118,14 @@ class OrderBook:
         """
         Get bid-ask spread
         """
+    def get_top_of_book(self) -> TopOfBook:
+        """
+        Get best bid and ask prices, quantities and order counts
+        """
+    def get_trade_summary(self) -> TradeSummary:
+        """
+        Get session and rolling-window OHLCV statistics
+        """
     def place_market_buy_order(self, quantity: int) -> None:
         """
         Place a market buy order
@@ -131,6 +175,56 @@ class Security:
         """
         Get the security ID
         """
+class SweepCost:
+    @property
+    def filled_quantity(self) -> int:
+        ...
+    @property
+    def levels_consumed(self) -> int:
+        ...
+    @property
+    def vwap(self) -> float:
+        ...
+    @property
+    def worst_price(self) -> int:
+        ...
+class TopOfBook:
+    def has_ask(self) -> bool:
+        """
+        Check if there is an ask
+        """
+    def has_bid(self) -> bool:
+        """
+        Check if there is a bid
+        """
+    @property
+    def ask_order_count(self) -> int:
+        ...
+    @property
+    def ask_price(self) -> int:
+        ...
+    @property
+    def ask_quantity(self) -> int:
+        ...
+    @property
+    def bid_order_count(self) -> int:
+        ...
+    @property
+    def bid_price(self) -> int:
+        ...
+    @property
+    def bid_quantity(self) -> int:
+        ...
+class TradeSummary:
+    @property
+    def session(self) -> Ohlcv:
+        ...
+    @property
+    def window(self) -> Ohlcv:
+        ...
+    @property
+    def window_ms(self) -> int:
+        ...
 def create_order(username: str, security_id: int, price: int, quantity: int, is_buy: bool) -> Order:
     """
     Create an order with auto-generated ID
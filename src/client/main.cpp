@@ -2,10 +2,13 @@
 #include <csignal>
 #include <memory>
 
+#include "receiver/BookBuilder.h"
 #include "receiver/MulticastReceiver.h"
 
 namespace {
-    std::unique_ptr<mdfeed::MulticastReceiver> receiver;
+    using BookReceiver = mdfeed::BasicMulticastReceiver<mdfeed::BookBuilder>;
+
+    std::unique_ptr<BookReceiver> receiver;
 
     void signal_handler(const int signal) {
         std::cout << "\nReceived signal " << signal << ", shutting down client..." << std::endl;
@@ -17,15 +20,11 @@ namespace {
 
 class MarketDataClient {
 private:
-    std::unique_ptr<mdfeed::MulticastReceiver> receiver_;
+    std::unique_ptr<BookReceiver> receiver_;
 
 public:
     explicit MarketDataClient(const mdfeed::ReceiverConfig &config)
-            : receiver_(std::make_unique<mdfeed::MulticastReceiver>(config)) {
-        receiver_->set_message_handler(
-                [](const mdfeed::MessageHeader &header, const void *data, const size_t length) {
-                    process_market_data(header, data, length);
-                });
+            : receiver_(std::make_unique<BookReceiver>(config)) {
     }
 
     bool start() const {
@@ -48,12 +47,23 @@ public:
         return receiver_ ? receiver_->get_stats() : mdfeed::MulticastReceiver::Stats{};
     }
 
-private:
-    static void process_market_data(const mdfeed::MessageHeader &header, const void *data, size_t length) {
-        (void) header;
-        (void) data;
-        (void) length;
-        // TODO: Implement
+    // the books belong to the receiver thread, only read them once it has stopped
+    void print_books() const {
+        const mdfeed::BookBuilder &books = receiver_->handler();
+        books.for_each_instrument([&books](const uint32_t instrument_id) {
+            const mdfeed::Bbo bbo = books.bbo(instrument_id);
+            std::cout << "Instrument " << instrument_id
+                      << ": bid " << bbo.bid.quantity << " @ " << bbo.bid.price
+                      << " | ask " << bbo.ask.quantity << " @ " << bbo.ask.price
+                      << " (" << books.depth(instrument_id, mdfeed::Side::BUY) << "x"
+                      << books.depth(instrument_id, mdfeed::Side::SELL) << " levels"
+                      << (books.is_consistent(instrument_id) ? "" : ", inconsistent") << ")" << std::endl;
+        });
+        const auto stats = books.get_stats();
+        std::cout << "Book Updates: " << stats.updates_applied
+                  << " (stale " << stats.stale_updates_skipped << ")" << std::endl;
+        std::cout << "Snapshots Applied: " << stats.snapshots_applied << std::endl;
+        std::cout << "Checksum Mismatches: " << stats.checksum_mismatches << std::endl;
     }
 };
 
@@ -78,6 +88,18 @@ int main(int argc, char *argv[]) {
             config.log_to_console = false;
         } else if (arg == "--no-validation") {
             config.validate_sequence_numbers = false;
+        } else if (arg == "--instrument" && i + 1 < argc) {
+            config.instruments.push_back(static_cast<uint32_t>(std::stoul(argv[++i])));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            config.receive_batch_size = std::stoul(argv[++i]);
+        } else if (arg == "--busy-poll") {
+            config.busy_poll = true;
+        } else if (arg == "--no-timestamps") {
+            config.kernel_timestamps = false;
+        } else if (arg == "--retransmit-port" && i + 1 < argc) {
+            config.retransmit_port = static_cast<uint16_t>(std::stoul(argv[++i]));
+        } else if (arg == "--snapshot-port" && i + 1 < argc) {
+            config.snapshot_port = static_cast<uint16_t>(std::stoul(argv[++i]));
         } else if (arg == "--stats-interval" && i + 1 < argc) {
             config.stats_interval = std::chrono::milliseconds(std::stoul(argv[++i]));
         } else if (arg == "--help" || arg == "-h") {
@@ -89,6 +111,12 @@ int main(int argc, char *argv[]) {
                       << "  --logfile <path>        Log to file instead of console\n"
                       << "  --no-console            Disable console logging\n"
                       << "  --no-validation         Disable sequence number validation\n"
+                      << "  --instrument <id>       Only receive this instrument, repeat for more; disables validation\n"
+                      << "  --batch <n>             Datagrams per receive call (default: " << config.receive_batch_size << ")\n"
+                      << "  --busy-poll             Spin on a non-blocking socket instead of blocking\n"
+                      << "  --no-timestamps         Skip kernel receive timestamps and latency histograms\n"
+                      << "  --retransmit-port <p>   Gap fill TCP port, 0 disables (default: " << config.retransmit_port << ")\n"
+                      << "  --snapshot-port <p>     Snapshot group port for gap recovery, 0 disables (default: " << config.snapshot_port << ")\n"
                       << "  --stats-interval <ms>   Statistics interval in ms (default: 5000)\n"
                       << "  --help, -h              Show this help message\n";
             return 0;
@@ -111,7 +139,7 @@ int main(int argc, char *argv[]) {
 
     try {
         MarketDataClient client(config);
-        receiver = std::make_unique<mdfeed::MulticastReceiver>(config);
+        receiver = std::make_unique<BookReceiver>(config);
 
         if (!client.start()) {
             std::cerr << "Failed to start market data client!" << std::endl;
@@ -128,8 +156,23 @@ int main(int argc, char *argv[]) {
         std::cout << "\n=== FINAL STATISTICS ===" << std::endl;
         std::cout << "Total Messages: " << stats.total_messages_received << std::endl;
         std::cout << "Total Bytes: " << stats.total_bytes_received << std::endl;
+        std::cout << "Receive Batches: " << stats.receive_batches << " (avg " << stats.average_batch_size()
+                  << ", max " << stats.max_batch_size << ")" << std::endl;
         std::cout << "Sequence Gaps: " << stats.sequence_gaps << std::endl;
+        std::cout << "Recovered Messages: " << stats.messages_recovered << std::endl;
+        std::cout << "Recoveries: " << stats.recoveries << " (" << stats.snapshot_recoveries
+                  << " from snapshots, " << stats.stale_transitions << " stale)" << std::endl;
         std::cout << "Invalid Messages: " << stats.invalid_messages << std::endl;
+        std::cout << "Filtered Messages: " << stats.filtered_messages << std::endl;
+        if (stats.wire_to_user.count > 0) {
+            std::cout << "Publish->Wire p50/p99/p99.9/max (ns): " << stats.publish_to_wire.p50_ns << "/"
+                      << stats.publish_to_wire.p99_ns << "/" << stats.publish_to_wire.p999_ns << "/"
+                      << stats.publish_to_wire.max_ns << std::endl;
+            std::cout << "Wire->User p50/p99/p99.9/max (ns): " << stats.wire_to_user.p50_ns << "/"
+                      << stats.wire_to_user.p99_ns << "/" << stats.wire_to_user.p999_ns << "/"
+                      << stats.wire_to_user.max_ns << std::endl;
+        }
+        client.print_books();
     }
     catch (const std::exception &e) {
         std::cerr << "Client error: " << e.what() << std::endl;
@@ -7,11 +7,9 @@ Exchange::Exchange(const Mode mode, mdfeed::PublisherConfig md_config,
       order_entry_port_(oe_port), generator_(rd_()), price_dist_(50000, 500),
       quantity_dist_(100, 20), bool_dist_(0.5)
 {
-    md_publisher_ = std::make_unique<mdfeed::MarketDataPublisher>(md_config_);
-    multicast_thread_ = std::make_unique<mdfeed::MulticastPublisherThread>(
-            md_publisher_->get_ring_buffer(), md_config_);
+    md_channels_ = std::make_unique<mdfeed::MarketDataChannels>(md_config_);
 
-    symbol_manager_ = std::make_unique<SymbolManager>(*md_publisher_);
+    symbol_manager_ = std::make_unique<SymbolManager>(*md_channels_);
 
     if (mode_ == Mode::CLIENT_ORDERS) {
         order_server_ = std::make_unique<orderentry::OrderEntryServer>(
@@ -22,9 +20,10 @@ Exchange::Exchange(const Mode mode, mdfeed::PublisherConfig md_config,
 bool Exchange::start()
 {
     if (running_.load()) return true;
-    std::cout << "Starting Multicast Publisher Thread..." << std::endl;
-    if (!multicast_thread_->start()) {
-        std::cerr << "Failed to start multicast publisher thread" << std::endl;
+    std::cout << "Starting " << md_channels_->channel_count()
+              << " Multicast Publisher Thread(s)..." << std::endl;
+    if (!md_channels_->start()) {
+        std::cerr << "Failed to start multicast publisher threads" << std::endl;
         return false;
     }
     if (mode_ == Mode::CLIENT_ORDERS) {
@@ -32,7 +31,7 @@ bool Exchange::start()
                   << "..." << std::endl;
         if (!order_server_->start()) {
             std::cerr << "Failed to start order entry server" << std::endl;
-            multicast_thread_->stop();
+            md_channels_->stop();
             return false;
         }
     }
@@ -60,7 +59,7 @@ void Exchange::stop()
     std::cout << "Stopping Enhanced Exchange..." << std::endl;
     running_.store(false);
     if (order_server_) { order_server_->stop(); }
-    if (multicast_thread_) { multicast_thread_->stop(); }
+    if (md_channels_) { md_channels_->stop(); }
     print_final_stats();
 }
 
@@ -130,6 +129,7 @@ void Exchange::simulation_loop()
         auto symbol_id = symbol_manager_->get_symbol_id(symbol);
         if (!order_book || !symbol_id) continue;
         simulate_trading_activity(order_book, *symbol_id, symbol);
+        md_channels_->flush_conflated();
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
 }
@@ -170,22 +170,21 @@ void Exchange::add_simulation_limit_order(
         OrderBook<mdfeed::MarketDataPublisher>* order_book,
         const uint32_t symbol_id, const std::string& symbol)
 {
-    auto best_bid = order_book->GetBestBidPrice();
-    auto best_ask = order_book->GetBestAskPrice();
+    const TopOfBook top = order_book->GetTopOfBook();
 
-    if (!best_bid.has_value() || !best_ask.has_value()) return;
+    if (!top.HasBid() || !top.HasAsk()) return;
 
-    double mid_price = (best_bid.value() + best_ask.value()) / 2.0;
+    double mid_price = (top.bidPrice + top.askPrice) / 2.0;
     bool is_buy = bool_dist_(generator_);
 
     long price;
     if (is_buy) {
-        double target_price = (best_bid.value() + mid_price) / 2.0;
+        double target_price = (top.bidPrice + mid_price) / 2.0;
         price = static_cast<long>(std::abs(std::normal_distribution<double>(
                 target_price, 200)(generator_)));
     }
     else {
-        double target_price = (best_ask.value() + mid_price) / 2.0;
+        double target_price = (top.askPrice + mid_price) / 2.0;
         price = static_cast<long>(std::abs(std::normal_distribution<double>(
                 target_price, 200)(generator_)));
     }
@@ -210,6 +209,8 @@ void Exchange::client_order_loop()
             process_client_order(order_buffer);
         }
         else {
+            // idle, so give conflated levels a chance to go out
+            md_channels_->flush_conflated();
             std::this_thread::sleep_for(std::chrono::microseconds(100));
         }
     }
@@ -283,13 +284,13 @@ void Exchange::handle_new_order(const orderentry::OrderBuffer& buffer)
     if (const uint64_t new_matched = order_book->GetOrdersMatched();
         new_matched > old_matched) {
         const uint64_t executed_qty = new_matched - old_matched;
-        auto best_price = msg->side == orderentry::Side::BUY
-                                  ? order_book->GetBestAskPrice()
-                                  : order_book->GetBestBidPrice();
+        const TopOfBook top = order_book->GetTopOfBook();
+        const bool is_buy = msg->side == orderentry::Side::BUY;
 
-        if (best_price.has_value()) {
+        if (is_buy ? top.HasAsk() : top.HasBid()) {
             send_execution_report(buffer.client_fd, msg->client_order_id,
-                                  order.OrderId(), best_price.value(),
+                                  order.OrderId(),
+                                  is_buy ? top.askPrice : top.bidPrice,
                                   executed_qty, order.CurrentQuantity(),
                                   msg->side);
         }
@@ -427,12 +428,36 @@ void Exchange::print_supported_symbols() const
 
 void Exchange::print_final_stats() const
 {
-    const auto stats = multicast_thread_->get_stats();
+    const auto stats = md_channels_->get_stats();
     std::cout << "\n=== FINAL EXCHANGE STATISTICS ===" << std::endl;
     std::cout << "Market Data Messages sent: " << stats.messages_sent
               << std::endl;
+    std::cout << "Market Data Packets sent: " << stats.packets_sent
+              << " in " << stats.bursts_sent << " bursts (avg "
+              << stats.average_burst_size() << ", max " << stats.max_burst_size
+              << ")" << std::endl;
     std::cout << "Market Data Send failures: " << stats.send_failures
+              << ", oversized messages dropped: " << stats.oversized_messages
               << std::endl;
+    std::cout << "Market Data Heartbeats sent: " << stats.heartbeats_sent
+              << std::endl;
+    std::cout << "Market Data Statistics sent: " << stats.statistics_sent
+              << std::endl;
+    std::cout << "Market Data Sender idle parks: " << stats.idle_parks
+              << std::endl;
+    const auto publisher_stats = md_channels_->get_publisher_stats();
+    std::cout << "Market Data Ring drops: " << publisher_stats.messages_dropped
+              << ", conflated updates: " << publisher_stats.updates_conflated
+              << " (" << publisher_stats.conflated_levels_sent
+              << " levels sent after conflation)" << std::endl;
+    const auto retransmit_stats = md_channels_->get_retransmit_stats();
+    std::cout << "Retransmit requests: " << retransmit_stats.requests << " ("
+              << retransmit_stats.packets_resent << " packets resent, "
+              << retransmit_stats.requests_too_old << " too old)" << std::endl;
+    const auto snapshot_stats = md_channels_->get_snapshot_stats();
+    std::cout << "Snapshots sent: " << snapshot_stats.snapshots_sent << " ("
+              << snapshot_stats.entries_sent << " entries, "
+              << snapshot_stats.cycles << " cycles)" << std::endl;
 
     if (order_server_) {
         auto [orders_received, connections] = order_server_->get_stats();
@@ -2,8 +2,7 @@
 
 #include "SymbolManager.h"
 #include "messages/OrderMessages.h"
-#include "publisher/MarketDataPublisher.h"
-#include "publisher/MulticastPublisherThread.h"
+#include "publisher/MarketDataChannels.h"
 #include "server/OrderEntryServer.h"
 #include "utils/PublisherConfig.h"
 #include <atomic>
@@ -24,8 +23,7 @@ private:
     Mode mode_;
     std::atomic<bool> running_;
 
-    std::unique_ptr<mdfeed::MarketDataPublisher> md_publisher_;
-    std::unique_ptr<mdfeed::MulticastPublisherThread> multicast_thread_;
+    std::unique_ptr<mdfeed::MarketDataChannels> md_channels_;
     mdfeed::PublisherConfig md_config_;
 
     std::unique_ptr<SymbolManager> symbol_manager_;
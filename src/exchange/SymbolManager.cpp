@@ -1,7 +1,7 @@
 #include "SymbolManager.h"
 
-SymbolManager::SymbolManager(mdfeed::MarketDataPublisher& md_publisher)
-    : md_publisher_(md_publisher)
+SymbolManager::SymbolManager(mdfeed::MarketDataChannels& md_channels)
+    : md_channels_(md_channels)
 {
     initialize_symbols();
 }
@@ -78,8 +78,8 @@ void SymbolManager::initialize_symbols()
         securities_[symbol_id] = std::make_unique<Security>(
                 std::move(name), std::move(ticker), symbol_id);
         adapters_[symbol_id] = std::make_unique<
-                mdfeed::MDAdapter<mdfeed::MarketDataPublisher>>(symbol_id,
-                                                                md_publisher_);
+                mdfeed::MDAdapter<mdfeed::MarketDataPublisher>>(
+                symbol_id, md_channels_.publisher_for(symbol_id));
         order_books_[symbol_id]
                 = std::make_unique<OrderBook<mdfeed::MarketDataPublisher>>(
                         *securities_[symbol_id], *adapters_[symbol_id]);
@@ -2,6 +2,7 @@
 
 #include "core/OrderBook.h"
 #include "publisher/MDAdapter.h"
+#include "publisher/MarketDataChannels.h"
 #include "publisher/MarketDataPublisher.h"
 #include "securities/Security.h"
 #include <memory>
@@ -31,10 +32,10 @@ private:
             std::unique_ptr<mdfeed::MDAdapter<mdfeed::MarketDataPublisher>>>
             adapters_;
     std::unordered_map<uint32_t, std::unique_ptr<Security>> securities_;
-    mdfeed::MarketDataPublisher& md_publisher_;
+    mdfeed::MarketDataChannels& md_channels_;
 
 public:
-    explicit SymbolManager(mdfeed::MarketDataPublisher& md_publisher);
+    explicit SymbolManager(mdfeed::MarketDataChannels& md_channels);
 
     OrderBook<mdfeed::MarketDataPublisher>* get_order_book(uint32_t symbol_id);
 
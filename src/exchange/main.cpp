@@ -1,8 +1,10 @@
 #include "Exchange.h"
 #include "utils/PublisherConfig.h"
+#include <algorithm>
 #include <csignal>
 #include <iostream>
 #include <memory>
+#include <sstream>
 
 namespace {
     std::unique_ptr<Exchange> exchange;
@@ -28,6 +30,22 @@ void print_usage(const char* program_name)
                  "(default: 9999)\n";
     std::cout << "  --md-interface <ip>      Market data interface IP "
                  "(default: 127.0.0.1)\n";
+    std::cout << "  --snapshot-ip <address>  Snapshot multicast IP, channel k "
+                 "adds k to its third octet (default: 239.1.1.2)\n";
+    std::cout << "  --snapshot-port <port>   Snapshot multicast port, 0 "
+                 "disables snapshots (default: 9998)\n";
+    std::cout << "  --retransmit-port <port> Gap fill TCP port, channel k "
+                 "serves on port + k, 0 disables (default: 9997)\n";
+    std::cout << "  --md-channels <n>        Market data channels, channel k "
+                 "adds k to the third octet of the MD IP (default: 1)\n";
+    std::cout << "  --compact                Delta/varint encode market data "
+                 "packets\n";
+    std::cout << "  --conflate               Conflate level updates when the "
+                 "market data ring is full\n";
+    std::cout << "  --md-wait <strategy>     Idle wait of the MD sender threads: "
+                 "spin, yield or park (default: yield)\n";
+    std::cout << "  --md-cpus <a,b,...>      CPU per MD channel sender thread\n";
+    std::cout << "  --md-fifo <priority>     Run MD sender threads SCHED_FIFO\n";
     std::cout << "  --oe-port <port>         Order entry TCP port (default: "
                  "8080, client mode only)\n";
     std::cout << "  --help, -h               Show this help message\n";
@@ -71,6 +89,52 @@ int main(const int argc, char* argv[])
         else if (arg == "--md-interface" && i + 1 < argc) {
             md_config.interface_ip = argv[++i];
         }
+        else if (arg == "--snapshot-ip" && i + 1 < argc) {
+            md_config.snapshot_ip = argv[++i];
+        }
+        else if (arg == "--snapshot-port" && i + 1 < argc) {
+            md_config.snapshot_port
+                    = static_cast<uint16_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--retransmit-port" && i + 1 < argc) {
+            md_config.retransmit_port
+                    = static_cast<uint16_t>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--md-channels" && i + 1 < argc) {
+            md_config.channel_count = std::stoul(argv[++i]);
+        }
+        else if (arg == "--compact") {
+            md_config.compact_encoding = true;
+        }
+        else if (arg == "--conflate") {
+            md_config.conflate_on_backpressure = true;
+        }
+        else if (arg == "--md-wait" && i + 1 < argc) {
+            if (std::string wait = argv[++i]; wait == "spin") {
+                md_config.wait_strategy = mdfeed::WaitStrategy::SPIN;
+            }
+            else if (wait == "yield") {
+                md_config.wait_strategy = mdfeed::WaitStrategy::SPIN_YIELD;
+            }
+            else if (wait == "park") {
+                md_config.wait_strategy = mdfeed::WaitStrategy::SPIN_PARK;
+            }
+            else {
+                std::cerr << "Invalid wait strategy: " << wait << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        else if (arg == "--md-cpus" && i + 1 < argc) {
+            std::stringstream cpus(argv[++i]);
+            for (std::string cpu; std::getline(cpus, cpu, ',');) {
+                md_config.channel_cpus.push_back(std::stoi(cpu));
+            }
+        }
+        else if (arg == "--md-fifo" && i + 1 < argc) {
+            md_config.sender_scheduler = mdfeed::SchedulerPolicy::FIFO;
+            md_config.sender_priority = std::stoi(argv[++i]);
+        }
         else if (arg == "--oe-port" && i + 1 < argc) {
             oe_port = static_cast<uint16_t>(std::stoul(argv[++i]));
         }
@@ -90,8 +154,15 @@ int main(const int argc, char* argv[])
               << (mode == Exchange::Mode::SIMULATION ? "SIMULATION"
                                                      : "CLIENT_ORDERS")
               << std::endl;
-    std::cout << "Market Data: " << md_config.multicast_ip << ":"
-              << md_config.multicast_port << std::endl;
+    for (size_t channel = 0; channel < std::max<size_t>(md_config.channel_count, 1);
+         ++channel) {
+        const auto channel_config = md_config.for_channel(channel);
+        std::cout << "Market Data channel " << channel << ": "
+                  << channel_config.multicast_ip << ":"
+                  << md_config.multicast_port << ", snapshots: "
+                  << channel_config.snapshot_ip << ":"
+                  << md_config.snapshot_port << std::endl;
+    }
     std::cout << "MD Interface: " << md_config.interface_ip << std::endl;
     if (mode == Exchange::Mode::CLIENT_ORDERS) {
         std::cout << "Order Entry Port: " << oe_port << std::endl;
@@ -1,7 +1,7 @@
 import random
 import time
 from collections import deque
-from typing import Deque
+from typing import Deque, Dict
 
 import pyqtgraph as pg
 from PyQt6.QtCore import QTimer
@@ -21,6 +21,7 @@ FRAME_RATE = 60
 MAX_AGE_SECONDS = 10
 SCALING_LOOKBACK_SECONDS = 5
 MAX_RENDERED_DEPTHS = 15
+SIDE_BID = 1
 
 
 class MainWindow(QMainWindow):
@@ -34,6 +35,8 @@ class MainWindow(QMainWindow):
         self.bid_price_data: Deque[float] = deque(maxlen=self.max_history)
         self.ask_price_data: Deque[float] = deque(maxlen=self.max_history)
         self.volume_data: Deque[float] = deque(maxlen=self.max_history)
+        self.bid_quantities: Dict[int, int] = {}
+        self.ask_quantities: Dict[int, int] = {}
 
         self.setup_ui()
 
@@ -217,9 +220,18 @@ class MainWindow(QMainWindow):
             price_y_range = self.price_chart.getViewBox().viewRange()[1]  # Get Y range from price chart
             self.depth_chart.setYRange(price_y_range[0], price_y_range[1])
 
+    def apply_level_changes(self):
+        for price, side, quantity in self.order_book.drain_level_changes().tolist():
+            levels = self.bid_quantities if side == SIDE_BID else self.ask_quantities
+            if quantity == 0:
+                levels.pop(price, None)
+            else:
+                levels[price] = quantity
+
     def update_depth_chart(self):
-        bid_quantities = self.order_book.get_bid_quantities()
-        ask_quantities = self.order_book.get_ask_quantities()
+        self.apply_level_changes()
+        bid_quantities = self.bid_quantities
+        ask_quantities = self.ask_quantities
 
         bid_prices = sorted(bid_quantities.keys(), reverse=True)[:MAX_RENDERED_DEPTHS]
         ask_prices = sorted(ask_quantities.keys())[:MAX_RENDERED_DEPTHS]
@@ -257,8 +269,8 @@ class MainWindow(QMainWindow):
         best_bid = self.order_book.get_best_bid_price()
         best_ask = self.order_book.get_best_ask_price()
 
-        bid_quantities = self.order_book.get_bid_quantities()
-        ask_quantities = self.order_book.get_ask_quantities()
+        bid_quantities = self.bid_quantities
+        ask_quantities = self.ask_quantities
         bid_depth = bid_quantities.get(best_bid, 0) if best_bid else 0
         ask_depth = ask_quantities.get(best_ask, 0) if best_ask else 0
 
@@ -0,0 +1,1251 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "common/TscClock.h"
+#include "messages/Messages.h"
+#include "publisher/MarketDataChannels.h"
+#include "publisher/MarketDataPublisher.h"
+#include "publisher/MulticastPublisher.h"
+#include "publisher/MulticastPublisherThread.h"
+#include "publisher/RetransmitServer.h"
+#include "publisher/SnapshotPublisherThread.h"
+#include "publisher/TradeStatistics.h"
+#include "receiver/BookBuilder.h"
+#include "receiver/MessageDispatch.h"
+#include "receiver/MessageJournal.h"
+#include "receiver/MulticastReceiver.h"
+#include "receiver/MulticastReceiverGroup.h"
+#include "receiver/RetransmitClient.h"
+#include "receiver/ShardedDispatcher.h"
+#include "utils/ConflationTable.h"
+#include "utils/FeedBooks.h"
+#include "utils/LatencyHistogram.h"
+#include "utils/PacketFraming.h"
+#include "utils/RingBuffer.h"
+#include "utils/WaitStrategy.h"
+
+static mdfeed::PriceLevelUpdateMessage createUpdate(uint64_t sequenceNumber, uint64_t price) {
+    mdfeed::PriceLevelUpdateMessage msg{};
+    mdfeed::message_utils::init_header(msg, mdfeed::MessageType::PRICE_LEVEL_UPDATE, sequenceNumber, 1);
+    msg.price = price;
+    msg.quantity = 10;
+    msg.side = mdfeed::Side::BUY;
+    msg.action = mdfeed::UpdateAction::NEW;
+    return msg;
+}
+
+TEST(MDFeedTests, PacketRoundTrip) {
+    mdfeed::PacketBuilder packet;
+    for (uint64_t seq = 5; seq < 8; ++seq) {
+        auto msg = createUpdate(seq, 100 + seq);
+        ASSERT_TRUE(packet.fits(sizeof(msg)));
+        packet.append(&msg, sizeof(msg));
+    }
+    const size_t length = packet.finish();
+    const auto *header = reinterpret_cast<const mdfeed::PacketHeader *>(packet.data());
+    EXPECT_EQ(header->first_sequence_number, 5);
+    EXPECT_EQ(header->last_sequence_number, 7);
+    EXPECT_EQ(header->message_count, 3);
+
+    std::vector<uint64_t> prices;
+    EXPECT_TRUE(mdfeed::for_each_message(packet.data(), length,
+                                         [&](const mdfeed::MessageHeader &, const void *data, size_t) {
+                                             prices.push_back(static_cast<const mdfeed::PriceLevelUpdateMessage *>(
+                                                                      data)->price);
+                                         }));
+    EXPECT_EQ(prices, (std::vector<uint64_t>{105, 106, 107}));
+    EXPECT_FALSE(mdfeed::for_each_message(packet.data(), length - 1,
+                                          [](const mdfeed::MessageHeader &, const void *, size_t) {}));
+}
+
+TEST(MDFeedTests, PacketRespectsByteBudget) {
+    const size_t budget = sizeof(mdfeed::PacketHeader) + 2 * sizeof(mdfeed::PriceLevelUpdateMessage);
+    mdfeed::PacketBuilder packet(budget);
+    auto msg = createUpdate(1, 100);
+    EXPECT_TRUE(packet.append(&msg, sizeof(msg)));
+    EXPECT_TRUE(packet.append(&msg, sizeof(msg)));
+    EXPECT_FALSE(packet.fits(sizeof(msg)));
+    EXPECT_FALSE(packet.append(&msg, sizeof(msg)));
+    EXPECT_EQ(packet.length(), budget);
+
+    // a message over the budget is refused even by an empty packet
+    mdfeed::PacketBuilder small(sizeof(mdfeed::PacketHeader) + sizeof(msg) - 1);
+    EXPECT_FALSE(small.append(&msg, sizeof(msg)));
+    EXPECT_TRUE(small.empty());
+}
+
+TEST(MDFeedTests, ByteRingWrapsAndRejectsWhenFull) {
+    mdfeed::ByteRing ring(256);
+    // 24 byte payloads take 32 bytes each, leaving 32 of the 256 bytes free
+    for (uint64_t i = 0; i < 7; ++i) {
+        void *slot = ring.claim(24);
+        ASSERT_NE(slot, nullptr);
+        *static_cast<uint64_t *>(slot) = i;
+        ring.commit(24);
+    }
+    EXPECT_EQ(ring.claim(72), nullptr);
+
+    for (uint64_t i = 0; i < 5; ++i) {
+        auto record = ring.peek();
+        ASSERT_TRUE(record);
+        EXPECT_EQ(*static_cast<const uint64_t *>(record.data), i);
+        ring.release();
+    }
+
+    // 80 bytes do not fit the 32 left before the end, so the record goes to the start
+    void *slot = ring.claim(72);
+    ASSERT_NE(slot, nullptr);
+    *static_cast<uint64_t *>(slot) = 99;
+    ring.commit(72);
+
+    for (uint64_t i = 5; i < 7; ++i) {
+        auto record = ring.peek();
+        ASSERT_TRUE(record);
+        EXPECT_EQ(*static_cast<const uint64_t *>(record.data), i);
+        ring.release();
+    }
+    auto wrapped = ring.peek();
+    ASSERT_TRUE(wrapped);
+    EXPECT_EQ(wrapped.length, 72);
+    EXPECT_EQ(*static_cast<const uint64_t *>(wrapped.data), 99);
+    ring.release();
+    EXPECT_FALSE(ring.peek());
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(MDFeedTests, ParkedConsumerWakesOnCommit) {
+    mdfeed::ByteRing ring(256);
+    mdfeed::IdleWaiter waiter(mdfeed::WaitStrategy::SPIN_PARK, std::chrono::microseconds{0},
+                              std::chrono::seconds{5}, &ring);
+
+    std::thread producer([&ring] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        *static_cast<uint64_t *>(ring.claim(8)) = 7;
+        ring.commit(8);
+    });
+
+    // with no spin phase the first empty poll parks; the commit must cut the 5s timeout short
+    const auto start = std::chrono::steady_clock::now();
+    while (!ring.peek()) {
+        EXPECT_TRUE(waiter.idle());
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{2});
+    producer.join();
+
+    auto record = ring.peek();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(*static_cast<const uint64_t *>(record.data), 7);
+}
+
+TEST(MDFeedTests, TscClockTracksSystemClock) {
+    auto &clock = common::TscClock::instance();
+    clock.recalibrate();
+    const auto system = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    const auto first = static_cast<int64_t>(common::TscClock::now_ns());
+    const auto second = static_cast<int64_t>(common::TscClock::now_ns());
+    EXPECT_LT(std::abs(first - system), 1000000);
+    EXPECT_GE(second, first);
+
+    const uint64_t start = clock.ticks();
+    const uint64_t end = clock.ticks();
+    EXPECT_LT(clock.ticks_to_ns(end - start), 1000000u);
+}
+
+TEST(MDFeedTests, TscClockRecalibratesFromSeveralThreads) {
+    auto &clock = common::TscClock::instance();
+    std::atomic<bool> done{false};
+    auto recalibrate = [&] {
+        while (!done.load()) {
+            clock.recalibrate();
+        }
+    };
+    std::thread first(recalibrate);
+    std::thread second(recalibrate);
+
+    // a torn anchor or a seqlock left odd by two writers would hang or skew these reads
+    auto system_ns = [] {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+    };
+    int64_t worst = 0;
+    for (int i = 0; i < 200000; ++i) {
+        // bracketed, so being descheduled between the reads does not count as skew
+        const int64_t before = system_ns();
+        const auto now = static_cast<int64_t>(common::TscClock::now_ns());
+        const int64_t after = system_ns();
+        worst = std::max({worst, before - now, now - after});
+    }
+    done.store(true);
+    first.join();
+    second.join();
+
+    EXPECT_LT(worst, 1000000);
+    // a single caller is never turned away
+    EXPECT_EQ(clock.recalibrate(), clock.using_tsc());
+}
+
+TEST(MDFeedTests, FeedBooksReplayLevelsIntoImages) {
+    mdfeed::FeedBooks books;
+    auto bid = createUpdate(1, 100);
+    books.apply(bid.header, &bid);
+    auto changed = createUpdate(2, 100);
+    changed.quantity = 4;
+    books.apply(changed.header, &changed);
+    auto better = createUpdate(3, 101);
+    books.apply(better.header, &better);
+    auto other = createUpdate(4, 99);
+    books.apply(other.header, &other);
+
+    mdfeed::PriceLevelDeleteMessage del{};
+    mdfeed::message_utils::init_header(del, mdfeed::MessageType::PRICE_LEVEL_DELETE, 5, 1);
+    del.price = 99;
+    del.side = mdfeed::Side::BUY;
+    books.apply(del.header, &del);
+
+    mdfeed::BookChecksum expected;
+    expected.update(mdfeed::Side::BUY, 100, 0, 4);
+    expected.update(mdfeed::Side::BUY, 101, 0, 10);
+    std::vector<std::pair<uint32_t, uint32_t>> seen;
+    uint32_t next = 0;
+    EXPECT_FALSE(books.for_each_checksum(next, [&](uint32_t instrument, uint32_t checksum) {
+        seen.emplace_back(instrument, checksum);
+        return true;
+    }));
+    ASSERT_EQ(seen.size(), 1);
+    EXPECT_EQ(seen[0].first, 1);
+    EXPECT_EQ(seen[0].second, expected.value());
+
+    mdfeed::BookImageSet images;
+    books.refresh_images(images, 5);
+    ASSERT_EQ(images.size(), 1);
+    const auto first = images[1];
+    EXPECT_EQ(first.sequence_number, 5);
+    EXPECT_EQ(first.depth->checksum, expected.value());
+    ASSERT_EQ(first.depth->bids.size(), 2);
+    EXPECT_EQ(first.depth->bids[0].price, 101);
+    EXPECT_EQ(first.depth->bids[1].quantity, 4);
+    EXPECT_TRUE(first.depth->asks.empty());
+
+    // nothing changed, so the levels are shared rather than rebuilt, but the image is current at 9
+    books.refresh_images(images, 9);
+    EXPECT_EQ(images[1].depth, first.depth);
+    EXPECT_EQ(images[1].sequence_number, 9);
+}
+
+static std::vector<const mdfeed::MessageHeader *> drainRing(mdfeed::MDRingBuffer *ring,
+                                                             std::vector<std::vector<char>> &storage) {
+    std::vector<const mdfeed::MessageHeader *> headers;
+    while (auto record = ring->peek()) {
+        const auto *bytes = static_cast<const char *>(record.data);
+        storage.emplace_back(bytes, bytes + record.length);
+        ring->release();
+    }
+    for (const auto &message: storage) {
+        headers.push_back(reinterpret_cast<const mdfeed::MessageHeader *>(message.data()));
+    }
+    return headers;
+}
+
+TEST(MDFeedTests, ConflationKeepsFinalLevelStateWhenRingIsFull) {
+    mdfeed::PublisherConfig config;
+    config.ring_buffer_bytes = 256;
+    config.conflate_on_backpressure = true;
+    mdfeed::MarketDataPublisher publisher(config);
+
+    // each update takes a 64 byte record, so four fill the ring
+    for (uint64_t price = 10; price < 14; ++price) {
+        publisher.publish_price_level_update(1, price, 1, mdfeed::Side::SELL, mdfeed::UpdateAction::NEW);
+    }
+    publisher.publish_price_level_update(1, 100, 5, mdfeed::Side::BUY, mdfeed::UpdateAction::CHANGE);
+    publisher.publish_price_level_update(1, 100, 7, mdfeed::Side::BUY, mdfeed::UpdateAction::CHANGE);
+    publisher.publish_price_level_update(1, 101, 3, mdfeed::Side::BUY, mdfeed::UpdateAction::NEW);
+    publisher.publish_price_level_delete(1, 101, mdfeed::Side::BUY);
+
+    std::vector<std::vector<char>> storage;
+    EXPECT_EQ(drainRing(publisher.get_ring_buffer(), storage).size(), 4);
+    EXPECT_TRUE(publisher.flush_conflated());
+
+    storage.clear();
+    const auto headers = drainRing(publisher.get_ring_buffer(), storage);
+    ASSERT_EQ(headers.size(), 1);
+    EXPECT_EQ(headers[0]->sequence_number, 5);
+    const auto *update = reinterpret_cast<const mdfeed::PriceLevelUpdateMessage *>(headers[0]);
+    EXPECT_EQ(update->price, 100);
+    EXPECT_EQ(update->quantity, 7);
+    EXPECT_EQ(update->action, mdfeed::UpdateAction::CHANGE);
+
+    const auto stats = publisher.get_stats();
+    EXPECT_EQ(stats.messages_dropped, 0);
+    EXPECT_EQ(stats.updates_conflated, 4);
+    EXPECT_EQ(stats.conflated_levels_sent, 1);
+}
+
+TEST(MDFeedTests, ConflationTableHoldsAFixedNumberOfLevels) {
+    mdfeed::ConflationTable table(2);
+    const mdfeed::ConflationTable::Key first{1, mdfeed::Side::BUY, 100};
+    const mdfeed::ConflationTable::Key second{2, mdfeed::Side::SELL, 100};
+    const mdfeed::ConflationTable::Key third{1, mdfeed::Side::SELL, 101};
+    EXPECT_TRUE(table.upsert(first, 5, true));
+    EXPECT_TRUE(table.upsert(second, 3, false));
+    EXPECT_FALSE(table.upsert(third, 1, false));
+    // a pending level still takes its latest quantity
+    EXPECT_TRUE(table.upsert(first, 9, false));
+    table.erase_if([](const mdfeed::ConflationTable::Key &key) { return key.instrument_id == 2; });
+    EXPECT_TRUE(table.upsert(third, 1, false));
+
+    // draining one level at a time leaves tombstones, which must not fill the slots
+    auto drain_one = [&table] {
+        bool once = true;
+        table.drain([&](const mdfeed::ConflationTable::Key &, const mdfeed::ConflationTable::Level &) {
+            return std::exchange(once, false);
+        });
+    };
+    drain_one();
+    for (uint64_t price = 200; price < 20000; ++price) {
+        ASSERT_TRUE(table.upsert({3, mdfeed::Side::BUY, price}, 1, false));
+        drain_one();
+    }
+    std::vector<uint64_t> quantities;
+    EXPECT_TRUE(table.drain([&](const mdfeed::ConflationTable::Key &, const mdfeed::ConflationTable::Level &level) {
+        quantities.push_back(level.quantity);
+        return true;
+    }));
+    EXPECT_EQ(quantities.size(), 1);
+    EXPECT_TRUE(table.empty());
+
+    mdfeed::PublisherConfig config;
+    config.ring_buffer_bytes = 256;
+    config.conflate_on_backpressure = true;
+    config.conflation_capacity = 1;
+    mdfeed::MarketDataPublisher publisher(config);
+    for (uint64_t price = 10; price < 14; ++price) {
+        publisher.publish_price_level_update(1, price, 1, mdfeed::Side::SELL, mdfeed::UpdateAction::NEW);
+    }
+    EXPECT_TRUE(publisher.publish_price_level_update(1, 100, 5, mdfeed::Side::BUY, mdfeed::UpdateAction::CHANGE));
+    // no room for a second level, so it is dropped and leaves a gap at 5
+    EXPECT_FALSE(publisher.publish_price_level_update(1, 101, 5, mdfeed::Side::BUY, mdfeed::UpdateAction::NEW));
+
+    std::vector<std::vector<char>> storage;
+    drainRing(publisher.get_ring_buffer(), storage);
+    EXPECT_TRUE(publisher.flush_conflated());
+    storage.clear();
+    const auto headers = drainRing(publisher.get_ring_buffer(), storage);
+    ASSERT_EQ(headers.size(), 1);
+    EXPECT_EQ(headers[0]->sequence_number, 6);
+    EXPECT_EQ(publisher.get_stats().messages_dropped, 1);
+    EXPECT_EQ(publisher.get_stats().conflation_table_full, 1);
+}
+
+TEST(MDFeedTests, DropsAreCountedAndLeaveASequenceGap) {
+    mdfeed::PublisherConfig config;
+    config.ring_buffer_bytes = 256;
+    mdfeed::MarketDataPublisher publisher(config);
+    for (uint64_t price = 10; price < 15; ++price) {
+        publisher.publish_price_level_update(1, price, 1, mdfeed::Side::SELL, mdfeed::UpdateAction::NEW);
+    }
+    std::vector<std::vector<char>> storage;
+    drainRing(publisher.get_ring_buffer(), storage);
+    publisher.publish_price_level_delete(1, 10, mdfeed::Side::SELL);
+
+    storage.clear();
+    const auto headers = drainRing(publisher.get_ring_buffer(), storage);
+    ASSERT_EQ(headers.size(), 1);
+    EXPECT_EQ(headers[0]->sequence_number, 6);
+    EXPECT_EQ(publisher.get_stats().messages_dropped, 1);
+}
+
+TEST(MDFeedTests, ChannelConfigMapsInstrumentsAndGroups) {
+    mdfeed::PublisherConfig config;
+    config.channel_count = 3;
+    config.instrument_channels[7] = 0;
+    config.channel_cpus = {2};
+    EXPECT_EQ(config.channel_of(4), 1);
+    EXPECT_EQ(config.channel_of(5), 2);
+    EXPECT_EQ(config.channel_of(7), 0);
+
+    EXPECT_EQ(config.for_channel(0).multicast_ip, "239.1.1.1");
+    EXPECT_EQ(config.for_channel(2).multicast_ip, "239.1.3.1");
+    EXPECT_EQ(config.for_channel(0).sender_cpu, 2);
+    EXPECT_EQ(config.for_channel(1).sender_cpu, -1);
+    EXPECT_EQ(config.for_channel(0).retransmit_port, 9997);
+    EXPECT_EQ(config.for_channel(2).retransmit_port, 9999);
+    EXPECT_EQ(config.for_channel(0).snapshot_ip, "239.1.1.2");
+    EXPECT_EQ(config.for_channel(2).snapshot_ip, "239.1.3.2");
+
+    config.channel_ips = {"239.2.0.1", "239.2.0.2"};
+    EXPECT_EQ(config.for_channel(1).multicast_ip, "239.2.0.2");
+    EXPECT_EQ(config.for_channel(2).multicast_ip, "239.1.3.1");
+
+    // a mapping past the last channel is a config error, not a move to channel 0
+    config.instrument_channels[9] = 3;
+    config.retransmit_port = 0;
+    config.snapshot_port = 0;
+    EXPECT_THROW(mdfeed::MarketDataChannels{config}, std::invalid_argument);
+}
+
+TEST(MDFeedTests, CompactPacketRoundTripsEveryMessage) {
+    std::vector<std::vector<char>> messages;
+    auto add = [&](const auto &msg) {
+        const auto *bytes = reinterpret_cast<const char *>(&msg);
+        messages.emplace_back(bytes, bytes + sizeof(msg));
+    };
+    add(createUpdate(40, 5000));
+    add(createUpdate(41, 4900));
+    auto offTick = createUpdate(42, 4901);
+    add(offTick);
+
+    mdfeed::TradeMessage trade{};
+    mdfeed::message_utils::init_header(trade, mdfeed::MessageType::TRADE, 43, 2);
+    trade.trade_id = 77;
+    trade.price = 5000;
+    trade.quantity = 3;
+    trade.aggressor_side = mdfeed::Side::SELL;
+    add(trade);
+
+    mdfeed::HeartbeatMessage heartbeat{};
+    mdfeed::message_utils::init_header(heartbeat, mdfeed::MessageType::HEARTBEAT, 43, 2);
+    heartbeat.checksum = 0xDEADBEEF;
+    add(heartbeat);
+
+    mdfeed::StatisticsMessage statistics{};
+    mdfeed::message_utils::init_header(statistics, mdfeed::MessageType::STATISTICS, 44, 1);
+    statistics.session_high = 5100;
+    add(statistics);
+
+    mdfeed::PacketBuilder compact(mdfeed::MAX_PACKET_SIZE, mdfeed::PacketFormat::COMPACT, 100);
+    mdfeed::PacketBuilder plain;
+    for (const auto &message: messages) {
+        ASSERT_TRUE(compact.fits(message.size()));
+        compact.append(message.data(), message.size());
+        plain.append(message.data(), message.size());
+    }
+    const size_t length = compact.finish();
+    EXPECT_LT(length, plain.finish());
+
+    size_t index = 0;
+    EXPECT_TRUE(mdfeed::for_each_message(compact.data(), length,
+                                         [&](const mdfeed::MessageHeader &, const void *data, size_t size) {
+                                             ASSERT_LT(index, messages.size());
+                                             ASSERT_EQ(size, messages[index].size());
+                                             EXPECT_EQ(std::memcmp(data, messages[index].data(), size), 0)
+                                                                 << "message " << index;
+                                             index++;
+                                         }));
+    EXPECT_EQ(index, messages.size());
+    EXPECT_FALSE(mdfeed::for_each_message(compact.data(), length - 1,
+                                          [](const mdfeed::MessageHeader &, const void *, size_t) {}));
+}
+
+TEST(MDFeedTests, RetransmitServerFillsRequestedRange) {
+    mdfeed::PublisherConfig config;
+    config.retransmit_port = 19997;
+    config.retransmit_packets = 4;
+    mdfeed::RetransmitServer server(config);
+
+    // six packets of two messages, sequence numbers 1-12; the store keeps the last four (5-12)
+    for (uint64_t first = 1; first <= 11; first += 2) {
+        mdfeed::PacketBuilder packet;
+        for (uint64_t seq = first; seq < first + 2; ++seq) {
+            auto msg = createUpdate(seq, 100 + seq);
+            packet.append(&msg, sizeof(msg));
+        }
+        server.store()->store(packet.data(), packet.finish());
+    }
+    ASSERT_TRUE(server.start());
+
+    mdfeed::RetransmitClient client("127.0.0.1", config.retransmit_port, std::chrono::milliseconds(1000));
+    std::vector<uint64_t> sequences;
+    auto collect = [&](const void *packet, size_t length) {
+        mdfeed::for_each_message(packet, length, [&](const mdfeed::MessageHeader &header, const void *, size_t) {
+            sequences.push_back(header.sequence_number);
+        });
+    };
+
+    // a client that stalls halfway through its request does not hold up the others
+    const int stalled = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(stalled, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.retransmit_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(connect(stalled, reinterpret_cast<const sockaddr *>(&address), sizeof(address)), 0);
+    mdfeed::RetransmitRequest partial{};
+    partial.first_sequence_number = 11;
+    partial.last_sequence_number = 12;
+    constexpr size_t half = sizeof(partial) / 2;
+    ASSERT_EQ(send(stalled, &partial, half, 0), static_cast<ssize_t>(half));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    mdfeed::RetransmitResponse response{};
+    ASSERT_TRUE(client.request(8, 10, collect, &response));
+    EXPECT_EQ(response.first_available, 5);
+    EXPECT_EQ(response.last_available, 12);
+    EXPECT_EQ(response.packet_count, 2);
+    EXPECT_EQ(sequences, (std::vector<uint64_t>{7, 8, 9, 10}));
+
+    // evicted numbers return nothing, and the connection stays usable
+    sequences.clear();
+    ASSERT_TRUE(client.request(1, 3, collect, &response));
+    EXPECT_EQ(response.packet_count, 0);
+    EXPECT_TRUE(sequences.empty());
+
+    // the rest of the stalled request completes it
+    const auto *rest = reinterpret_cast<const char *>(&partial) + half;
+    ASSERT_EQ(send(stalled, rest, sizeof(partial) - half, 0), static_cast<ssize_t>(sizeof(partial) - half));
+    mdfeed::RetransmitResponse stalled_response{};
+    ASSERT_EQ(recv(stalled, &stalled_response, sizeof(stalled_response), MSG_WAITALL),
+              static_cast<ssize_t>(sizeof(stalled_response)));
+    EXPECT_EQ(stalled_response.packet_count, 1);
+    close(stalled);
+
+    server.stop();
+    EXPECT_EQ(server.get_stats().requests, 3);
+    EXPECT_EQ(server.get_stats().requests_too_old, 1);
+}
+
+TEST(MDFeedTests, JournalFormatsEntriesOffThreadAndDropsWhenFull) {
+    const std::string path = testing::TempDir() + "mdfeed_journal_test.log";
+    std::remove(path.c_str());
+    {
+        mdfeed::MessageJournal journal(false, path, 256, std::chrono::milliseconds(1));
+        ASSERT_TRUE(journal.is_open());
+        auto msg = createUpdate(42, 1234);
+        // nothing drains before start(), so the small ring fills up
+        journal.record_text("gap detected");
+        journal.record(&msg, sizeof(msg));
+        for (int i = 0; i < 8; ++i) {
+            journal.record(&msg, sizeof(msg));
+        }
+        EXPECT_GT(journal.dropped_entries(), 0u);
+        journal.start();
+        journal.stop();
+    }
+
+    std::ifstream file(path);
+    std::string first;
+    std::string second;
+    std::getline(file, first);
+    std::getline(file, second);
+    EXPECT_EQ(first, "gap detected");
+    EXPECT_NE(second.find("seq=42"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+namespace {
+    struct TypedHandler {
+        std::vector<uint64_t> updatePrices;
+        std::vector<uint16_t> otherTypes;
+
+        void on_price_level_update(const mdfeed::PriceLevelUpdateMessage &msg) { updatePrices.push_back(msg.price); }
+
+        void on_message(const mdfeed::MessageHeader &header, const void *, size_t) {
+            otherTypes.push_back(header.message_type);
+        }
+    };
+}
+
+TEST(MDFeedTests, DispatchPrefersTypedCallbacks) {
+    TypedHandler handler;
+    auto update = createUpdate(1, 250);
+    mdfeed::dispatch_message(handler, update.header, &update, sizeof(update));
+    mdfeed::TradeMessage trade{};
+    mdfeed::message_utils::init_header(trade, mdfeed::MessageType::TRADE, 2, 1);
+    mdfeed::dispatch_message(handler, trade.header, &trade, sizeof(trade));
+    // too short for its type, so it falls back to on_message
+    mdfeed::dispatch_message(handler, update.header, &update, sizeof(mdfeed::MessageHeader));
+
+    EXPECT_EQ(handler.updatePrices, (std::vector<uint64_t>{250}));
+    EXPECT_EQ(handler.otherTypes, (std::vector<uint16_t>{static_cast<uint16_t>(mdfeed::MessageType::TRADE),
+                                                         static_cast<uint16_t>(mdfeed::MessageType::PRICE_LEVEL_UPDATE)}));
+
+    size_t seen = 0;
+    mdfeed::FunctionMessageHandler adapter{[&](const mdfeed::MessageHeader &, const void *, size_t) { seen++; }};
+    mdfeed::dispatch_message(adapter, update.header, &update, sizeof(update));
+    mdfeed::dispatch_message(adapter, trade.header, &trade, sizeof(trade));
+    EXPECT_EQ(seen, 2u);
+}
+
+TEST(MDFeedTests, BookBuilderKeepsSortedLevelsAndAppliesSnapshots) {
+    mdfeed::BookBuilder builder(4);
+    mdfeed::BookChecksum expected;
+    // more levels than the touch scan, so deep updates take the binary search
+    for (uint64_t i = 0; i < 12; ++i) {
+        const uint64_t price = 100 + (i * 7) % 12;
+        builder.on_price_level_update(createUpdate(i + 1, price));
+        expected.update(mdfeed::Side::BUY, price, 0, 10);
+    }
+    auto ask = createUpdate(13, 115);
+    ask.side = mdfeed::Side::SELL;
+    builder.on_price_level_update(ask);
+    ask = createUpdate(14, 113);
+    ask.side = mdfeed::Side::SELL;
+    builder.on_price_level_update(ask);
+    expected.update(mdfeed::Side::SELL, 115, 0, 10);
+    expected.update(mdfeed::Side::SELL, 113, 0, 10);
+
+    mdfeed::PriceLevelDeleteMessage del{};
+    mdfeed::message_utils::init_header(del, mdfeed::MessageType::PRICE_LEVEL_DELETE, 15, 1);
+    del.price = 103;
+    del.side = mdfeed::Side::BUY;
+    builder.on_price_level_delete(del);
+    expected.update(mdfeed::Side::BUY, 103, 10, 0);
+    auto changed = createUpdate(16, 101);
+    changed.quantity = 3;
+    builder.on_price_level_update(changed);
+    expected.update(mdfeed::Side::BUY, 101, 10, 3);
+    // already applied, so skipped
+    builder.on_price_level_update(createUpdate(16, 50));
+
+    const mdfeed::Bbo bbo = builder.bbo(1);
+    EXPECT_EQ(bbo.bid.price, 111);
+    EXPECT_EQ(bbo.ask.price, 113);
+    EXPECT_EQ(builder.depth(1, mdfeed::Side::BUY), 11);
+    mdfeed::BookLevel top[20];
+    ASSERT_EQ(builder.top_levels(1, mdfeed::Side::BUY, top), 11);
+    for (size_t i = 1; i < 11; ++i) {
+        EXPECT_GT(top[i - 1].price, top[i].price);
+    }
+    EXPECT_EQ(top[9].price, 101);
+    EXPECT_EQ(top[9].quantity, 3);
+    ASSERT_EQ(builder.top_levels(1, mdfeed::Side::SELL, std::span(top, 1)), 1);
+    EXPECT_EQ(top[0].price, 113);
+    EXPECT_EQ(builder.checksum(1), expected.value());
+    EXPECT_EQ(builder.get_stats().stale_updates_skipped, 1);
+
+    mdfeed::HeartbeatMessage heartbeat{};
+    mdfeed::message_utils::init_header(heartbeat, mdfeed::MessageType::HEARTBEAT, 16, 1);
+    heartbeat.checksum = expected.value();
+    builder.on_heartbeat(heartbeat);
+    EXPECT_TRUE(builder.is_consistent(1));
+
+    // an older image is ignored, a newer one replaces the book
+    auto snapshot = [&](uint64_t sequence, uint32_t checksum) {
+        mdfeed::SnapshotBeginMessage begin{};
+        mdfeed::message_utils::init_header(begin, mdfeed::MessageType::SNAPSHOT_BEGIN, sequence, 1);
+        begin.total_entries = 1;
+        builder.on_snapshot_begin(begin);
+        mdfeed::SnapshotEntryMessage entry{};
+        mdfeed::message_utils::init_header(entry, mdfeed::MessageType::SNAPSHOT_ENTRY, sequence, 1);
+        entry.price = 90;
+        entry.quantity = 5;
+        entry.side = mdfeed::Side::SELL;
+        builder.on_snapshot_entry(entry);
+        mdfeed::SnapshotEndMessage end{};
+        mdfeed::message_utils::init_header(end, mdfeed::MessageType::SNAPSHOT_END, sequence, 1);
+        end.checksum = checksum;
+        builder.on_snapshot_end(end);
+    };
+    const uint32_t image = mdfeed::BookChecksum::level_hash(mdfeed::Side::SELL, 90, 5);
+    snapshot(10, image);
+    EXPECT_EQ(builder.depth(1, mdfeed::Side::BUY), 11);
+    snapshot(20, image);
+    EXPECT_EQ(builder.depth(1, mdfeed::Side::BUY), 0);
+    EXPECT_EQ(builder.bbo(1).ask.price, 90);
+    EXPECT_EQ(builder.sequence_number(1), 20);
+    EXPECT_TRUE(builder.is_consistent(1));
+    EXPECT_EQ(builder.get_stats().snapshots_applied, 1);
+
+    mdfeed::BookClearMessage clear{};
+    mdfeed::message_utils::init_header(clear, mdfeed::MessageType::BOOK_CLEAR, 21, 1);
+    builder.on_book_clear(clear);
+    EXPECT_EQ(builder.bbo(1).ask.quantity, 0);
+    EXPECT_EQ(builder.checksum(1), 0);
+
+    heartbeat.header.sequence_number = 21;
+    heartbeat.checksum = 1;
+    builder.on_heartbeat(heartbeat);
+    EXPECT_FALSE(builder.is_consistent(1));
+    EXPECT_EQ(builder.get_stats().checksum_mismatches, 1);
+    EXPECT_EQ(builder.bbo(2).bid.quantity, 0);
+}
+
+TEST(MDFeedTests, ReceiverHoldsMessagesBackUntilSnapshotRecovers) {
+    mdfeed::ReceiverConfig config;
+    config.multicast_ip = "239.1.1.21";
+    config.multicast_port = 19995;
+    config.snapshot_ip = "239.1.1.22";
+    config.snapshot_port = 19994;
+    config.retransmit_port = 0;
+    config.enable_logging = false;
+    config.stats_interval = std::chrono::milliseconds(10);
+    // non-blocking, so stop() does not wait for another datagram
+    config.busy_poll = true;
+    mdfeed::BasicMulticastReceiver<mdfeed::BookBuilder> receiver(config);
+    ASSERT_TRUE(receiver.start());
+
+    mdfeed::MulticastPublisher incremental;
+    mdfeed::MulticastPublisher snapshots;
+    ASSERT_TRUE(incremental.initialize(config.multicast_ip, config.multicast_port, config.interface_ip));
+    ASSERT_TRUE(snapshots.initialize(config.snapshot_ip, config.snapshot_port, config.interface_ip));
+    auto send = [](mdfeed::MulticastPublisher &publisher, const auto &... messages) {
+        mdfeed::PacketBuilder packet;
+        (packet.append(&messages, sizeof(messages)), ...);
+        ASSERT_TRUE(publisher.send(packet.data(), packet.finish()));
+    };
+    auto wait_for = [&](mdfeed::FeedState state) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (receiver.feed_state() != state && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return receiver.feed_state() == state;
+    };
+
+    send(incremental, createUpdate(1, 100), createUpdate(2, 101));
+    // 3 and 4 are lost, and there is no retransmit server
+    send(incremental, createUpdate(5, 104), createUpdate(6, 105));
+    ASSERT_TRUE(wait_for(mdfeed::FeedState::RECOVERING));
+
+    // an image from before the gap does not cover it
+    mdfeed::SnapshotBeginMessage old_begin{};
+    mdfeed::message_utils::init_header(old_begin, mdfeed::MessageType::SNAPSHOT_BEGIN, 2, 1);
+    send(snapshots, old_begin);
+
+    mdfeed::BookChecksum checksum;
+    mdfeed::SnapshotBeginMessage begin{};
+    mdfeed::message_utils::init_header(begin, mdfeed::MessageType::SNAPSHOT_BEGIN, 4, 1);
+    begin.total_entries = 4;
+    std::vector<mdfeed::SnapshotEntryMessage> entries(4);
+    for (uint64_t i = 0; i < entries.size(); ++i) {
+        mdfeed::message_utils::init_header(entries[i], mdfeed::MessageType::SNAPSHOT_ENTRY, 4, 1);
+        entries[i].price = 100 + i;
+        entries[i].quantity = 10;
+        entries[i].side = mdfeed::Side::BUY;
+        checksum.update(mdfeed::Side::BUY, 100 + i, 0, 10);
+    }
+    mdfeed::SnapshotEndMessage end{};
+    mdfeed::message_utils::init_header(end, mdfeed::MessageType::SNAPSHOT_END, 4, 1);
+    end.checksum = checksum.value();
+    send(snapshots, begin, entries[0], entries[1], entries[2], entries[3], end);
+    EXPECT_EQ(receiver.feed_state(), mdfeed::FeedState::RECOVERING);
+    // the next cycle shows every instrument has been sent
+    mdfeed::SnapshotBeginMessage next_cycle = begin;
+    next_cycle.header.sequence_number = 6;
+    send(snapshots, next_cycle);
+    ASSERT_TRUE(wait_for(mdfeed::FeedState::LIVE));
+
+    send(incremental, createUpdate(7, 106));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    receiver.stop();
+
+    const auto stats = receiver.get_stats();
+    EXPECT_EQ(stats.recoveries, 1);
+    EXPECT_EQ(stats.snapshot_recoveries, 1);
+    EXPECT_EQ(stats.messages_replayed, 2);
+    EXPECT_EQ(stats.sequence_gaps, 2);
+
+    const mdfeed::BookBuilder &books = receiver.handler();
+    EXPECT_EQ(books.feed_state(), mdfeed::FeedState::LIVE);
+    EXPECT_TRUE(books.is_consistent(1));
+    EXPECT_EQ(books.depth(1, mdfeed::Side::BUY), 7);
+    EXPECT_EQ(books.sequence_number(1), 7);
+    // 5 was held back and replayed after the image at 4, not skipped or applied twice
+    EXPECT_EQ(books.get_stats().updates_applied, 5);
+    EXPECT_EQ(books.get_stats().snapshots_applied, 1);
+}
+
+TEST(MDFeedTests, SnapshotRecoversABookThatWentIdleInsideTheGap) {
+    mdfeed::ReceiverConfig config;
+    config.multicast_ip = "239.1.1.36";
+    config.multicast_port = 19997;
+    config.snapshot_ip = "239.1.1.37";
+    config.snapshot_port = 19998;
+    config.retransmit_port = 0;
+    config.enable_logging = false;
+    config.stats_interval = std::chrono::milliseconds(10);
+    config.busy_poll = true;
+    mdfeed::BasicMulticastReceiver<mdfeed::BookBuilder> receiver(config);
+    ASSERT_TRUE(receiver.start());
+
+    mdfeed::PublisherConfig publisher_config;
+    publisher_config.snapshot_ip = config.snapshot_ip;
+    publisher_config.snapshot_port = config.snapshot_port;
+    publisher_config.snapshot_interval = std::chrono::milliseconds(10);
+    mdfeed::SnapshotPublisherThread snapshots(publisher_config);
+    mdfeed::MulticastPublisher incremental;
+    ASSERT_TRUE(incremental.initialize(config.multicast_ip, config.multicast_port, config.interface_ip));
+
+    // the publisher's replica sees every message, the receiver only those sent
+    mdfeed::FeedBooks books;
+    mdfeed::BookImageSet images;
+    auto publish = [&](uint64_t sequenceNumber, uint32_t instrumentId, uint64_t price, bool lost) {
+        auto msg = createUpdate(sequenceNumber, price);
+        msg.header.instrument_id = instrumentId;
+        books.apply(msg.header, &msg);
+        books.refresh_images(images, sequenceNumber);
+        snapshots.update_images(images);
+        if (!lost) {
+            mdfeed::PacketBuilder packet;
+            packet.append(&msg, sizeof(msg));
+            ASSERT_TRUE(incremental.send(packet.data(), packet.finish()));
+        }
+    };
+
+    publish(1, 1, 100, false);
+    publish(2, 2, 200, false);
+    // instrument 1 changes inside the gap and then goes quiet
+    publish(3, 1, 101, true);
+    publish(4, 2, 201, true);
+    publish(5, 2, 202, false);
+    auto wait_for = [&](mdfeed::FeedState state) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (receiver.feed_state() != state && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return receiver.feed_state() == state;
+    };
+    ASSERT_TRUE(wait_for(mdfeed::FeedState::RECOVERING));
+
+    ASSERT_TRUE(snapshots.start());
+    EXPECT_TRUE(wait_for(mdfeed::FeedState::LIVE));
+    snapshots.stop();
+    receiver.stop();
+
+    EXPECT_EQ(receiver.get_stats().recoveries, 1);
+    EXPECT_EQ(receiver.get_stats().snapshot_recoveries, 1);
+    const mdfeed::BookBuilder &received = receiver.handler();
+    EXPECT_EQ(received.feed_state(), mdfeed::FeedState::LIVE);
+    EXPECT_TRUE(received.is_consistent(1));
+    EXPECT_EQ(received.depth(1, mdfeed::Side::BUY), 2);
+    EXPECT_TRUE(received.is_consistent(2));
+    EXPECT_EQ(received.depth(2, mdfeed::Side::BUY), 3);
+}
+
+TEST(MDFeedTests, LatencyHistogramReportsPercentilesWithinBucketError) {
+    mdfeed::LatencyHistogram histogram;
+    EXPECT_EQ(histogram.summary().p99_ns, 0);
+    // 1us..1000us, one sample each
+    for (uint64_t us = 1; us <= 1000; ++us) {
+        histogram.record(us * 1000);
+    }
+    const mdfeed::LatencySummary summary = histogram.summary();
+    EXPECT_EQ(summary.count, 1000);
+    EXPECT_EQ(summary.max_ns, 1000000);
+    auto near = [](uint64_t reported, uint64_t exact) {
+        return reported >= exact && reported <= exact + exact / mdfeed::LatencyHistogram::SUB_BUCKETS;
+    };
+    EXPECT_PRED2(near, summary.p50_ns, 500000);
+    EXPECT_PRED2(near, summary.p99_ns, 990000);
+    EXPECT_PRED2(near, summary.p999_ns, 999000);
+
+    // small values are exact, huge ones are clamped into the last bucket but keep max
+    for (uint64_t ns = 0; ns < 2 * mdfeed::LatencyHistogram::SUB_BUCKETS; ++ns) {
+        EXPECT_EQ(mdfeed::LatencyHistogram::upper_bound_of(mdfeed::LatencyHistogram::bucket_of(ns)), ns);
+    }
+    histogram.record(UINT64_MAX);
+    EXPECT_EQ(histogram.max(), UINT64_MAX);
+    EXPECT_EQ(mdfeed::LatencyHistogram::bucket_of(mdfeed::LatencyHistogram::MAX_NS),
+              mdfeed::LatencyHistogram::BUCKET_COUNT - 1);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0);
+
+    // a stats thread can summarise while the receiver thread records
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint64_t ns = 1; ns <= 200000; ++ns) {
+            histogram.record(ns);
+        }
+        done.store(true);
+    });
+    uint64_t last_count = 0;
+    while (!done.load()) {
+        const mdfeed::LatencySummary partial = histogram.summary();
+        EXPECT_GE(partial.count, last_count);
+        EXPECT_LE(partial.p50_ns, partial.max_ns);
+        last_count = partial.count;
+    }
+    writer.join();
+    EXPECT_EQ(histogram.summary().count, 200000);
+    EXPECT_EQ(histogram.summary().max_ns, 200000);
+}
+
+namespace {
+    struct CountingHandler {
+        std::atomic<uint64_t> *updates = nullptr;
+
+        void on_price_level_update(const mdfeed::PriceLevelUpdateMessage &) { (*updates)++; }
+    };
+
+    struct StatisticsRecorder {
+        std::atomic<uint64_t> *received = nullptr;
+        mdfeed::StatisticsMessage last{};
+
+        void on_statistics(const mdfeed::StatisticsMessage &msg) {
+            last = msg;
+            (*received)++;
+        }
+    };
+
+    struct HeartbeatRecorder {
+        std::atomic<uint64_t> *last_sequence = nullptr;
+        mdfeed::HeartbeatMessage last{};
+        std::set<uint32_t> instruments{};
+
+        void on_heartbeat(const mdfeed::HeartbeatMessage &msg) {
+            last = msg;
+            instruments.insert(msg.header.instrument_id);
+            last_sequence->store(msg.header.sequence_number);
+        }
+    };
+
+    struct SequenceRecorder {
+        std::vector<uint64_t> sequences{};
+
+        void on_price_level_update(const mdfeed::PriceLevelUpdateMessage &msg) {
+            sequences.push_back(msg.header.sequence_number);
+        }
+    };
+}
+
+TEST(MDFeedTests, ReceiverGroupTracksEachChannelOnOneThread) {
+    mdfeed::ReceiverConfig common;
+    common.enable_logging = false;
+    std::atomic<uint64_t> updates{0};
+    mdfeed::MulticastReceiverGroup<CountingHandler> group(common, CountingHandler{&updates});
+
+    mdfeed::MulticastPublisher publishers[2];
+    for (size_t i = 0; i < 2; ++i) {
+        mdfeed::ReceiverConfig channel;
+        channel.multicast_ip = "239.1.1." + std::to_string(31 + i);
+        channel.multicast_port = static_cast<uint16_t>(19990 - i);
+        channel.retransmit_port = 0;
+        channel.snapshot_port = 0;
+        ASSERT_EQ(group.add_channel(channel), static_cast<int>(i));
+        ASSERT_TRUE(publishers[i].initialize(channel.multicast_ip, channel.multicast_port, channel.interface_ip));
+    }
+    ASSERT_TRUE(group.start());
+
+    auto send = [](mdfeed::MulticastPublisher &publisher, uint64_t seq) {
+        mdfeed::PacketBuilder packet;
+        auto msg = createUpdate(seq, 100);
+        packet.append(&msg, sizeof(msg));
+        return publisher.send(packet.data(), packet.finish());
+    };
+    // both channels number their messages from 1; only the second one skips 3
+    for (uint64_t seq : {1, 2, 3, 4}) {
+        ASSERT_TRUE(send(publishers[0], seq));
+    }
+    for (uint64_t seq : {1, 2, 4}) {
+        ASSERT_TRUE(send(publishers[1], seq));
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (updates.load() < 7 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    group.stop();
+
+    EXPECT_EQ(updates.load(), 7);
+    EXPECT_EQ(group.get_stats(0).total_messages_received, 4);
+    EXPECT_EQ(group.get_stats(0).sequence_gaps, 0);
+    EXPECT_EQ(group.get_stats(1).total_messages_received, 3);
+    EXPECT_EQ(group.get_stats(1).sequence_gaps, 1);
+}
+
+TEST(MDFeedTests, ShardedDispatcherRunsEachInstrumentOnItsShard) {
+    mdfeed::ReceiverConfig config;
+    config.dispatch_shards = 2;
+    // small enough that the producer has to wait on the workers
+    config.dispatch_ring_bytes = 4096;
+    mdfeed::ShardedDispatcher<mdfeed::BookBuilder> dispatcher(config);
+    ASSERT_TRUE(dispatcher.start());
+
+    // called from this thread the way the receiver thread would
+    uint64_t seq = 0;
+    for (uint64_t round = 0; round < 500; ++round) {
+        for (uint32_t instrument = 1; instrument <= 4; ++instrument) {
+            auto msg = createUpdate(++seq, 100 + round);
+            msg.header.instrument_id = instrument;
+            dispatcher.on_message(msg.header, &msg, sizeof(msg));
+        }
+    }
+    dispatcher.on_feed_state(mdfeed::FeedState::STALE);
+    dispatcher.stop();
+
+    for (size_t shard = 0; shard < 2; ++shard) {
+        const auto stats = dispatcher.get_stats(shard);
+        EXPECT_EQ(stats.messages_dispatched, 1000u);
+        EXPECT_EQ(stats.messages_handled, 1000u);
+        EXPECT_EQ(stats.messages_dropped, 0u);
+
+        mdfeed::BookBuilder &books = dispatcher.handler(shard);
+        EXPECT_EQ(books.get_stats().updates_applied, 1000u);
+        EXPECT_EQ(books.feed_state(), mdfeed::FeedState::STALE);
+        for (uint32_t instrument = 1; instrument <= 4; ++instrument) {
+            EXPECT_EQ(books.depth(instrument, mdfeed::Side::BUY), dispatcher.shard_of(instrument) == shard ? 500u : 0u);
+        }
+    }
+}
+
+TEST(MDFeedTests, InstrumentFilterDropsUnwantedPacketsInTheKernel) {
+    mdfeed::ReceiverConfig config;
+    config.multicast_ip = "239.1.1.33";
+    config.multicast_port = 19988;
+    config.enable_logging = false;
+    config.busy_poll = true;
+    config.instruments = {2};
+    config.stats_interval = std::chrono::milliseconds(10);
+    std::atomic<uint64_t> updates{0};
+    mdfeed::BasicMulticastReceiver<CountingHandler> receiver(config, CountingHandler{&updates});
+    ASSERT_TRUE(receiver.start());
+
+    mdfeed::MulticastPublisher publisher;
+    ASSERT_TRUE(publisher.initialize(config.multicast_ip, config.multicast_port, config.interface_ip));
+    uint64_t seq = 0;
+    auto send = [&](std::initializer_list<uint32_t> instruments) {
+        mdfeed::PacketBuilder packet;
+        for (const uint32_t instrument : instruments) {
+            auto msg = createUpdate(++seq, 100);
+            msg.header.instrument_id = instrument;
+            packet.append(&msg, sizeof(msg));
+        }
+        return publisher.send(packet.data(), packet.finish());
+    };
+    ASSERT_TRUE(send({1}));
+    ASSERT_TRUE(send({2}));
+    ASSERT_TRUE(send({1, 3}));
+    // kept for its second message, the first is dropped after parsing
+    ASSERT_TRUE(send({3, 2}));
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (updates.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    receiver.stop();
+
+    const auto stats = receiver.get_stats();
+    EXPECT_EQ(updates.load(), 2);
+    EXPECT_EQ(stats.total_packets_received, 2);
+    EXPECT_EQ(stats.filtered_messages, 1);
+    // the missing sequence numbers are not gaps
+    EXPECT_EQ(stats.sequence_gaps, 0);
+}
+
+TEST(MDFeedTests, TradeStatisticsDecayAndAreSentByThePublisherThread) {
+    constexpr uint64_t SECOND = 1000000000;
+    mdfeed::TradeStatistics statistics;
+    statistics.on_trade(100, 5, 10 * SECOND);
+    statistics.on_trade(102, 5, 11 * SECOND);
+    EXPECT_EQ(statistics.summary(11 * SECOND).window.volume, 10);
+    // the first bucket has left the window, the second not yet
+    EXPECT_EQ(statistics.summary(70 * SECOND).window.volume, 5);
+    EXPECT_EQ(statistics.summary(71 * SECOND).window.trade_count, 0);
+    EXPECT_EQ(statistics.summary(71 * SECOND).session.volume, 10);
+
+    mdfeed::PublisherConfig config;
+    config.multicast_ip = "239.1.1.34";
+    config.multicast_port = 19987;
+    config.heartbeat_interval = std::chrono::milliseconds(0);
+    config.statistics_interval = std::chrono::milliseconds(10);
+    mdfeed::MarketDataPublisher publisher(config);
+    mdfeed::MulticastPublisherThread sender(publisher.get_ring_buffer(), config);
+
+    mdfeed::ReceiverConfig receiver_config;
+    receiver_config.multicast_ip = config.multicast_ip;
+    receiver_config.multicast_port = config.multicast_port;
+    receiver_config.retransmit_port = 0;
+    receiver_config.snapshot_port = 0;
+    receiver_config.enable_logging = false;
+    receiver_config.busy_poll = true;
+    receiver_config.stats_interval = std::chrono::milliseconds(10);
+    std::atomic<uint64_t> received{0};
+    mdfeed::BasicMulticastReceiver<StatisticsRecorder> receiver(receiver_config, StatisticsRecorder{&received});
+    ASSERT_TRUE(receiver.start());
+    ASSERT_TRUE(sender.start());
+
+    publisher.publish_trade(1, 7, 100, 4, mdfeed::Side::BUY);
+    publisher.publish_price_level_update(1, 99, 10, mdfeed::Side::BUY, mdfeed::UpdateAction::NEW);
+    // sent every interval whether or not the instrument trades again
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (received.load() < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sender.stop();
+    receiver.stop();
+
+    EXPECT_GE(received.load(), 3);
+    const mdfeed::StatisticsMessage &last = receiver.handler().last;
+    EXPECT_EQ(last.header.instrument_id, 1);
+    // repeats the update's number rather than taking one
+    EXPECT_EQ(last.header.sequence_number, 2);
+    EXPECT_EQ(last.session_volume, 4);
+    EXPECT_EQ(last.window_trade_count, 1);
+    EXPECT_EQ(receiver.get_stats().sequence_gaps, 0);
+}
+
+TEST(MDFeedTests, PublisherThreadHeartbeatsRepeatTheLastSequenceNumber) {
+    mdfeed::PublisherConfig config;
+    config.multicast_ip = "239.1.1.35";
+    config.multicast_port = 19996;
+    config.heartbeat_interval = std::chrono::milliseconds(10);
+    mdfeed::MarketDataPublisher publisher(config);
+    mdfeed::MulticastPublisherThread sender(publisher.get_ring_buffer(), config);
+
+    mdfeed::ReceiverConfig receiver_config;
+    receiver_config.multicast_ip = config.multicast_ip;
+    receiver_config.multicast_port = config.multicast_port;
+    receiver_config.retransmit_port = 0;
+    receiver_config.snapshot_port = 0;
+    receiver_config.enable_logging = false;
+    receiver_config.busy_poll = true;
+    receiver_config.stats_interval = std::chrono::milliseconds(10);
+    std::atomic<uint64_t> last_sequence{0};
+    mdfeed::BasicMulticastReceiver<HeartbeatRecorder> receiver(receiver_config, HeartbeatRecorder{&last_sequence});
+    ASSERT_TRUE(receiver.start());
+    ASSERT_TRUE(sender.start());
+
+    publisher.publish_price_level_update(1, 100, 10, mdfeed::Side::BUY, mdfeed::UpdateAction::NEW);
+    publisher.publish_price_level_update(1, 101, 5, mdfeed::Side::BUY, mdfeed::UpdateAction::NEW);
+    // the feed then goes idle, so only heartbeats follow
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (last_sequence.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sender.stop();
+    receiver.stop();
+
+    const mdfeed::HeartbeatMessage &last = receiver.handler().last;
+    EXPECT_EQ(last.header.instrument_id, 1);
+    EXPECT_EQ(last.header.sequence_number, 2);
+    EXPECT_GE(sender.get_stats().heartbeats_sent, 1);
+    EXPECT_EQ(receiver.get_stats().sequence_gaps, 0);
+}
+
+TEST(MDFeedTests, HeartbeatsCoverMoreInstrumentsThanOneBurst) {
+    mdfeed::PublisherConfig config;
+    config.multicast_ip = "239.1.1.38";
+    config.multicast_port = 19999;
+    config.heartbeat_interval = std::chrono::milliseconds(10);
+    config.max_packet_size = sizeof(mdfeed::PacketHeader) + 2 * sizeof(mdfeed::PriceLevelUpdateMessage);
+    config.max_burst_datagrams = 1;
+    // instruments for three bursts of heartbeats
+    const uint32_t per_burst = static_cast<uint32_t>(
+            (config.max_packet_size - sizeof(mdfeed::PacketHeader)) / sizeof(mdfeed::HeartbeatMessage));
+    const uint32_t instruments = 3 * per_burst;
+    mdfeed::MarketDataPublisher publisher(config);
+    mdfeed::MulticastPublisherThread sender(publisher.get_ring_buffer(), config);
+
+    mdfeed::ReceiverConfig receiver_config;
+    receiver_config.multicast_ip = config.multicast_ip;
+    receiver_config.multicast_port = config.multicast_port;
+    receiver_config.retransmit_port = 0;
+    receiver_config.snapshot_port = 0;
+    receiver_config.enable_logging = false;
+    receiver_config.busy_poll = true;
+    receiver_config.stats_interval = std::chrono::milliseconds(10);
+    std::atomic<uint64_t> last_sequence{0};
+    mdfeed::BasicMulticastReceiver<HeartbeatRecorder> receiver(receiver_config, HeartbeatRecorder{&last_sequence});
+    ASSERT_TRUE(receiver.start());
+    ASSERT_TRUE(sender.start());
+
+    for (uint32_t instrument = 1; instrument <= instruments; ++instrument) {
+        publisher.publish_price_level_update(instrument, 100, 10, mdfeed::Side::BUY, mdfeed::UpdateAction::NEW);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (last_sequence.load() < instruments && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // one whole round of heartbeats after the last update
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sender.stop();
+    receiver.stop();
+
+    EXPECT_EQ(receiver.handler().instruments.size(), instruments);
+    EXPECT_EQ(receiver.get_stats().sequence_gaps, 0);
+}
+
+TEST(MDFeedTests, ReceiverKeepsReadingWhileAGapFillIsOutstanding) {
+    // a retransmit server that answers only when the test does
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(listener, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(20000);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)), 0);
+    ASSERT_EQ(listen(listener, 1), 0);
+
+    mdfeed::ReceiverConfig config;
+    config.multicast_ip = "239.1.1.39";
+    config.multicast_port = 20001;
+    config.retransmit_port = 20000;
+    config.retransmit_timeout = std::chrono::seconds(2);
+    config.snapshot_port = 0;
+    config.enable_logging = false;
+    config.stats_interval = std::chrono::milliseconds(10);
+    config.busy_poll = true;
+    mdfeed::BasicMulticastReceiver<SequenceRecorder> receiver(config);
+    ASSERT_TRUE(receiver.start());
+
+    mdfeed::MulticastPublisher incremental;
+    ASSERT_TRUE(incremental.initialize(config.multicast_ip, config.multicast_port, config.interface_ip));
+    auto publish = [&](uint64_t first, uint64_t last) {
+        mdfeed::PacketBuilder packet;
+        for (uint64_t seq = first; seq <= last; ++seq) {
+            auto msg = createUpdate(seq, 100 + seq);
+            packet.append(&msg, sizeof(msg));
+        }
+        ASSERT_TRUE(incremental.send(packet.data(), packet.finish()));
+    };
+
+    publish(1, 2);
+    // 3 and 4 are lost
+    publish(5, 6);
+    pollfd pending{listener, POLLIN, 0};
+    ASSERT_EQ(poll(&pending, 1, 2000), 1);
+    const int server = accept(listener, nullptr, nullptr);
+    ASSERT_GE(server, 0);
+    mdfeed::RetransmitRequest request{};
+    ASSERT_EQ(recv(server, &request, sizeof(request), MSG_WAITALL), static_cast<ssize_t>(sizeof(request)));
+    EXPECT_EQ(request.first_sequence_number, 3);
+    EXPECT_EQ(request.last_sequence_number, 4);
+
+    // with the request unanswered the receiver reads on, holding 7 back behind the gap
+    EXPECT_EQ(receiver.feed_state(), mdfeed::FeedState::RECOVERING);
+    publish(7, 7);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    mdfeed::PacketBuilder packet;
+    for (uint64_t seq = 3; seq <= 4; ++seq) {
+        auto msg = createUpdate(seq, 100 + seq);
+        packet.append(&msg, sizeof(msg));
+    }
+    const size_t length = packet.finish();
+    mdfeed::RetransmitResponse response{};
+    response.first_available = 1;
+    response.last_available = 7;
+    response.packet_count = 1;
+    ASSERT_EQ(send(server, &response, sizeof(response), 0), static_cast<ssize_t>(sizeof(response)));
+    ASSERT_EQ(send(server, packet.data(), length, 0), static_cast<ssize_t>(length));
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (receiver.feed_state() != mdfeed::FeedState::LIVE && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(receiver.feed_state(), mdfeed::FeedState::LIVE);
+    receiver.stop();
+    close(server);
+    close(listener);
+
+    const auto stats = receiver.get_stats();
+    EXPECT_EQ(stats.recoveries, 1);
+    EXPECT_EQ(stats.messages_recovered, 2);
+    EXPECT_EQ(stats.recovery_failures, 0);
+    EXPECT_EQ(stats.messages_replayed, 3);
+    EXPECT_EQ(receiver.handler().sequences, (std::vector<uint64_t>{1, 2, 3, 4, 5, 6, 7}));
+}
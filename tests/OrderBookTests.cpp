@@ -135,4 +135,143 @@ TEST(OrderBookTests, CanMatch) {
     EXPECT_EQ(bids.begin()->GetLimit()->GetOrderCount(), 1);
     EXPECT_EQ(bids.begin()->GetLimit()->GetOrderQuantity(), 15);
     EXPECT_EQ(bids.begin()->CurrentOrder().OrderId(), modifiedOrder.OrderId());
-}
\ No newline at end of file
+}
+
+TEST(OrderBookTests, ChecksumTracksLevels) {
+    const int SECURITY_ID = 1;
+    const std::string USERNAME = "test";
+    auto book = createOrderBook();
+    EXPECT_EQ(book.GetChecksum(), 0);
+    Order bid(OrderCore(USERNAME, SECURITY_ID), 48, 15, true);
+    Order ask(OrderCore(USERNAME, SECURITY_ID), 50, 5, false);
+    book.AddOrder(bid);
+    book.AddOrder(ask);
+    uint32_t expected = mdfeed::BookChecksum::level_hash(mdfeed::Side::BUY, 48, 15)
+                        + mdfeed::BookChecksum::level_hash(mdfeed::Side::SELL, 50, 5);
+    EXPECT_EQ(book.GetChecksum(), expected);
+
+    Order crossing(OrderCore(USERNAME, SECURITY_ID), 48, 10, false);
+    book.AddOrder(crossing);
+    expected = mdfeed::BookChecksum::level_hash(mdfeed::Side::BUY, 48, 5)
+               + mdfeed::BookChecksum::level_hash(mdfeed::Side::SELL, 50, 5);
+    EXPECT_EQ(book.GetChecksum(), expected);
+
+    book.RemoveOrder(bid.OrderId());
+    book.RemoveOrder(ask.OrderId());
+    EXPECT_EQ(book.GetChecksum(), 0);
+}
+
+TEST(OrderBookTests, ChecksumIsOrderIndependent) {
+    const int SECURITY_ID = 1;
+    const std::string USERNAME = "test";
+    auto first = createOrderBook();
+    auto second = createOrderBook();
+    first.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 47, 10, true));
+    first.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 51, 20, false));
+    first.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 47, 5, true));
+    second.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 51, 20, false));
+    second.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 47, 15, true));
+    EXPECT_EQ(first.GetChecksum(), second.GetChecksum());
+}
+
+TEST(OrderBookTests, CostToFillSweepsLevels) {
+    const int SECURITY_ID = 1;
+    const std::string USERNAME = "test";
+    auto book = createOrderBook();
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 50, 10, false));
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 52, 10, false));
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 48, 5, true));
+
+    SweepCost cost = book.GetCostToFill(15, true);
+    EXPECT_EQ(cost.filledQuantity, 15);
+    EXPECT_EQ(cost.levelsConsumed, 2);
+    EXPECT_EQ(cost.worstPrice, 52);
+    EXPECT_DOUBLE_EQ(cost.vwap, (50.0 * 10 + 52.0 * 5) / 15);
+
+    // a new level in front of the cached ones must be picked up
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 49, 10, false));
+    cost = book.GetCostToFill(15, true);
+    EXPECT_EQ(cost.levelsConsumed, 2);
+    EXPECT_EQ(cost.worstPrice, 50);
+    EXPECT_DOUBLE_EQ(cost.vwap, (49.0 * 10 + 50.0 * 5) / 15);
+
+    cost = book.GetCostToFill(100, false);
+    EXPECT_EQ(cost.filledQuantity, 5);
+    EXPECT_EQ(cost.levelsConsumed, 1);
+    EXPECT_EQ(cost.worstPrice, 48);
+}
+
+TEST(OrderBookTests, DrainLevelChangesReturnsOnlyTouchedLevels) {
+    const int SECURITY_ID = 1;
+    const std::string USERNAME = "test";
+    auto book = createOrderBook();
+    Order bid(OrderCore(USERNAME, SECURITY_ID), 48, 15, true);
+    book.AddOrder(bid);
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 50, 5, false));
+    EXPECT_EQ(book.DrainLevelChanges().size(), 2);
+    EXPECT_TRUE(book.DrainLevelChanges().empty());
+
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 48, 5, true));
+    book.RemoveOrder(bid.OrderId());
+    auto changes = book.DrainLevelChanges();
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].price, 48);
+    EXPECT_EQ(changes[0].quantity, 5);
+    EXPECT_TRUE(changes[0].isBid);
+
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 50, 5, true));
+    changes = book.DrainLevelChanges();
+    ASSERT_EQ(changes.size(), 1);
+    EXPECT_EQ(changes[0].quantity, 0);
+    EXPECT_FALSE(changes[0].isBid);
+}
+
+TEST(OrderBookTests, TopOfBookFollowsMutations) {
+    const int SECURITY_ID = 1;
+    const std::string USERNAME = "test";
+    auto book = createOrderBook();
+    TopOfBook top = book.GetTopOfBook();
+    EXPECT_FALSE(top.HasBid());
+    EXPECT_FALSE(top.HasAsk());
+
+    Order bid(OrderCore(USERNAME, SECURITY_ID), 48, 15, true);
+    book.AddOrder(bid);
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 48, 5, true));
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 50, 5, false));
+    top = book.GetTopOfBook();
+    EXPECT_EQ(top.bidPrice, 48);
+    EXPECT_EQ(top.bidQuantity, 20);
+    EXPECT_EQ(top.bidOrderCount, 2);
+    EXPECT_EQ(top.askPrice, 50);
+    EXPECT_EQ(top.askQuantity, 5);
+    EXPECT_EQ(top.askOrderCount, 1);
+
+    book.PlaceMarketBuyOrder(5);
+    book.RemoveOrder(bid.OrderId());
+    top = book.GetTopOfBook();
+    EXPECT_FALSE(top.HasAsk());
+    EXPECT_EQ(top.askQuantity, 0);
+    EXPECT_EQ(top.bidQuantity, 5);
+    EXPECT_EQ(top.bidOrderCount, 1);
+}
+
+TEST(OrderBookTests, TradeSummaryAccumulatesFills) {
+    const int SECURITY_ID = 1;
+    const std::string USERNAME = "test";
+    auto book = createOrderBook();
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 50, 10, false));
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 52, 10, false));
+    book.PlaceMarketBuyOrder(15);
+    book.AddOrder(Order(OrderCore(USERNAME, SECURITY_ID), 51, 5, true));
+    book.PlaceMarketSellOrder(5);
+
+    const mdfeed::TradeSummary summary = book.GetTradeSummary();
+    EXPECT_EQ(summary.session.trade_count, 3);
+    EXPECT_EQ(summary.session.open, 50);
+    EXPECT_EQ(summary.session.high, 52);
+    EXPECT_EQ(summary.session.low, 50);
+    EXPECT_EQ(summary.session.close, 51);
+    EXPECT_EQ(summary.session.volume, 20);
+    EXPECT_EQ(summary.session.vwap(), (50 * 10 + 52 * 5 + 51 * 5) / 20);
+    EXPECT_EQ(summary.window.volume, 20);
+}